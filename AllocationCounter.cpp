@@ -0,0 +1,149 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+static std::atomic<long long> allocations(0);
+static thread_local long long threadAllocations = 0;  // Constant-initialized, so usable before main
+static std::atomic<AllocationHook> allocationHook(NULL);
+
+long long AllocationCount() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+long long ThreadAllocationCount() {
+    return threadAllocations;
+}
+
+void SetAllocationHook(AllocationHook hook) {
+    allocationHook.store(hook, std::memory_order_release);
+}
+
+static void CountAllocation(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    threadAllocations++;
+    AllocationHook hook = allocationHook.load(std::memory_order_acquire);
+    if (hook != NULL) {
+        hook(size);
+    }
+}
+
+// malloc for size bytes at the given alignment (a power of two), or NULL
+static void* Allocate(std::size_t size, std::size_t alignment) {
+    CountAllocation(size);
+    if (size == 0) {
+        size = 1;  // new must return a distinct pointer even for zero bytes
+    }
+    if (alignment <= alignof(std::max_align_t)) {
+        return malloc(size);
+    }
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    void* memory = NULL;
+    return posix_memalign(&memory, alignment < sizeof(void*) ? sizeof(void*) : alignment, size) == 0 ? memory : NULL;
+#endif
+}
+
+static void Free(void* memory, std::size_t alignment) {
+#ifdef _WIN32
+    if (alignment > alignof(std::max_align_t)) {
+        _aligned_free(memory);
+        return;
+    }
+#endif
+    (void)alignment;
+    free(memory);
+}
+
+static void* AllocateOrThrow(std::size_t size, std::size_t alignment) {
+    void* memory = Allocate(size, alignment);
+    if (memory == NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new(std::size_t size) {
+    return AllocateOrThrow(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size) {
+    return AllocateOrThrow(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return AllocateOrThrow(size, (std::size_t)alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return AllocateOrThrow(size, (std::size_t)alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return Allocate(size, (std::size_t)alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return Allocate(size, (std::size_t)alignment);
+}
+
+void operator delete(void* memory) noexcept {
+    Free(memory, alignof(std::max_align_t));
+}
+
+void operator delete[](void* memory) noexcept {
+    Free(memory, alignof(std::max_align_t));
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    Free(memory, alignof(std::max_align_t));
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    Free(memory, alignof(std::max_align_t));
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    Free(memory, alignof(std::max_align_t));
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    Free(memory, alignof(std::max_align_t));
+}
+
+void operator delete(void* memory, std::align_val_t alignment) noexcept {
+    Free(memory, (std::size_t)alignment);
+}
+
+void operator delete[](void* memory, std::align_val_t alignment) noexcept {
+    Free(memory, (std::size_t)alignment);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept {
+    Free(memory, (std::size_t)alignment);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept {
+    Free(memory, (std::size_t)alignment);
+}
+
+void operator delete(void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    Free(memory, (std::size_t)alignment);
+}
+
+void operator delete[](void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    Free(memory, (std::size_t)alignment);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+// Counts heap allocations by replacing the global operator new and delete
+// (every form: arrays, nothrow, aligned, sized). Linking AllocationCounter.cpp
+// into a program is enough to count everything it allocates through C++; the
+// functions below read the counts. Memory allocated with malloc directly (the
+// GL driver, stdio) is not seen.
+//
+// The game's frames and ticks allocate nothing once warmed up: every pool is
+// sized when the game starts. The counts let the profiler overlay show that,
+// and AllocationTest.cpp fail when something starts allocating again:
+//     long long before = ThreadAllocationCount();
+//     RenderGameFrame();
+//     int frameAllocations = (int)(ThreadAllocationCount() - before);
+
+// Allocations by all threads since the program started
+long long AllocationCount();
+
+// Allocations by the calling thread since it started. Other threads (the
+// mixer, the logger writer) allocate on their own schedule, so this is the
+// count to take around a frame or a tick.
+long long ThreadAllocationCount();
+
+// Called with the size of every allocation, on the allocating thread, while
+// set; NULL to stop. For finding out what allocates, e.g. by setting a
+// breakpoint in the hook. The hook must not allocate itself.
+typedef void (*AllocationHook)(std::size_t bytes);
+void SetAllocationHook(AllocationHook hook);
@@ -0,0 +1,123 @@
+// Test that the game stops allocating once it has warmed up: no heap
+// allocation (AllocationCounter.h) in any simulation tick or any frame after
+// the first round, round restarts included.
+//
+// The simulation part plays rounds with the lookahead bot, a chunk feed and a
+// replay being recorded, as `QuickRunner --demo --record` does. The frame part
+// draws game frames in an offscreen EGL context (HUD text off, as in
+// FrameBench) and is skipped if there is none. GL drivers allocate too, mostly
+// when they compile a pipeline for a state they have not seen yet, so the
+// frames are measured while the warm-up sequence is played a second time.
+//
+// Usage: AllocationTest [rounds]  (exit status 1 if anything allocated)
+#include <cstdio>
+#include <cstdlib>
+#include "AllocationCounter.h"
+#include "ChunkFeed.h"
+#include "GameWorld.h"
+#include "InputPolicy.h"
+#include "OffscreenContext.h"
+#include "QuickRunnerIO.h"
+#include "Replay.h"
+
+const int kFrameWidth = 800;
+const int kFrameHeight = 600;
+const int kTestFrames = 2400;  // 40 seconds of play: long enough to lose a round without input
+
+static thread_local std::size_t firstAllocationBytes = 0;  // Size of this thread's first allocation since it was reset
+
+static void RememberAllocation(std::size_t bytes) {
+    if (firstAllocationBytes == 0) {
+        firstAllocationBytes = bytes;
+    }
+}
+
+// Play one round with the bot, recording it into a fresh Replay. Returns
+// its allocations after BeginReplay, which reserves the recording's room, so
+// a recording that reserved too little for a whole round counts.
+static long long PlayRound(GameWorld& world, ChunkFeed& feed, unsigned int seed) {
+    Replay replay;
+    BeginReplay(replay, seed);
+    firstAllocationBytes = 0;
+    long long before = ThreadAllocationCount();
+    InitGameWorld(world, seed);
+    StartChunkFeed(feed, world);
+    while (!world.gameEnd && !world.gameLose) {
+        TickInput input = PlanLookaheadInput(world);
+        RecordReplayTick(replay, input);
+        StepGameWorld(world, input);
+    }
+    FinishReplay(replay, world);
+    StopChunkFeed(feed);
+    return ThreadAllocationCount() - before;
+}
+
+// The first round warms up, every later one must not allocate
+static bool TestSimulation(int rounds) {
+    static GameWorld world;
+    static ChunkFeed feed;
+    InitChunkFeed(feed);
+    bool passed = true;
+    for (int round = 0; round <= rounds; round++) {
+        long long allocations = PlayRound(world, feed, 1 + round);
+        if (round == 0) {
+            printf("simulation: warm-up round allocated %lld times\n", allocations);
+        }
+        else if (allocations != 0) {
+            printf("simulation: round %d (seed %d, %ld ticks) allocated %lld times, first %zu bytes\n",
+                   round, 1 + round, world.tick, allocations, firstAllocationBytes);
+            passed = false;
+        }
+    }
+    ShutdownChunkFeed(feed);
+    if (passed) {
+        printf("simulation: %d rounds without allocating\n", rounds);
+    }
+    return passed;
+}
+
+// Play kTestFrames frames, one tick each, from a fresh round. When measuring,
+// returns the number of frames that allocated.
+static int PlayFrames(bool measure) {
+    RestartGame(1);
+    int allocatingFrames = 0;
+    for (int frame = 0; frame < kTestFrames; frame++) {
+        firstAllocationBytes = 0;
+        long long before = ThreadAllocationCount();
+        RunGameTicks(1);
+        RenderGameFrame();
+        long long allocations = ThreadAllocationCount() - before;
+        if (measure && allocations != 0) {
+            if (allocatingFrames < 10) {
+                printf("frames: frame %d allocated %lld times, first %zu bytes\n", frame, allocations, firstAllocationBytes);
+            }
+            allocatingFrames++;
+        }
+    }
+    return allocatingFrames;
+}
+
+static bool TestFrames() {
+    if (!CreateOffscreenContext(kFrameWidth, kFrameHeight)) {
+        printf("frames: skipped, no offscreen EGL context\n");
+        return true;
+    }
+    InitializeGame(false);
+    PlayFrames(false);
+    int allocatingFrames = PlayFrames(true);
+    if (allocatingFrames > 0) {
+        printf("frames: %d of %d frames allocated\n", allocatingFrames, kTestFrames);
+        return false;
+    }
+    printf("frames: %d frames without allocating\n", kTestFrames);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 3;
+    SetAllocationHook(RememberAllocation);
+    bool passed = TestSimulation(rounds > 0 ? rounds : 1);
+    passed = TestFrames() && passed;
+    SetAllocationHook(NULL);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+// Headless benchmark for the audio mixer (AudioMixer.h): measures what
+// triggering an effect costs the game thread while the mixing thread runs,
+// and how much faster than real time the mixer can fill blocks with every
+// voice busy. Optionally renders a short scripted mix to a WAV file.
+//
+// Run it from the directory holding the game's WAV files.
+// Usage: AudioBench [triggers] [out.wav]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "AudioMixer.h"
+
+static AudioMixer mixer;
+
+static const struct {
+    SoundId sound;
+    const char* path;
+} soundFiles[] = {
+    { SoundCoin, "coin.wav" },
+    { SoundObstacle, "obstacle.wav" },
+    { SoundMagnet, "Magnet.wav" },
+    { SoundInvincible, "invincible.wav" },
+    { SoundGameOver, "GameOver.wav" },
+};
+const int kEffectCount = sizeof(soundFiles) / sizeof(soundFiles[0]);
+
+static void LoadSounds() {
+    InitAudioMixer(mixer);
+    for (int i = 0; i < kEffectCount; i++) {
+        SoundBuffer& buffer = mixer.sounds[soundFiles[i].sound];
+        if (LoadSound(mixer, soundFiles[i].sound, soundFiles[i].path)) {
+            printf("loaded %-16s %7d frames\n", soundFiles[i].path, buffer.frameCount);
+        }
+        else {
+            printf("missing %s\n", soundFiles[i].path);
+        }
+    }
+}
+
+// Trigger effects from this thread while the mixer drains the queue on its own,
+// timing every call. The game triggers at most a few effects per tick.
+static void BenchTriggers(int triggers) {
+    StartAudioMixer(mixer, CreateNullSink(false));
+    std::vector<double> costs(triggers);
+    for (int i = 0; i < triggers; i++) {
+        auto start = std::chrono::steady_clock::now();
+        PlaySoundEffect(mixer, soundFiles[i % kEffectCount].sound);
+        auto end = std::chrono::steady_clock::now();
+        costs[i] = std::chrono::duration<double, std::nano>(end - start).count();
+        if (i % 16 == 15) {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));  // Leave the queue room, like ticks would
+        }
+    }
+    StopAudioMixer(mixer);
+
+    std::sort(costs.begin(), costs.end());
+    printf("trigger: %d calls  p50 %.0f ns  p99 %.0f ns  max %.0f ns  dropped %d\n", triggers,
+           costs[triggers / 2], costs[(size_t)(triggers * 0.99)], costs[triggers - 1], mixer.droppedCommands);
+}
+
+// Mix with every voice playing and compare against the time the audio lasts
+static void BenchMixing() {
+    std::vector<short> block(kMixBlockFrames * kMixChannels);
+    PlayMusic(mixer, SoundGameOver);
+    for (int i = 1; i < kMaxVoices; i++) {
+        PlaySoundEffect(mixer, soundFiles[i % kEffectCount].sound);
+    }
+
+    const int blocks = 20000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < blocks; i++) {
+        MixAudio(mixer, block.data(), kMixBlockFrames);
+        if (i % 64 == 0) {
+            for (int v = 1; v < kMaxVoices; v++) {
+                PlaySoundEffect(mixer, soundFiles[v % kEffectCount].sound);  // Keep the pool full
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double audioSeconds = (double)blocks * kMixBlockFrames / kMixRate;
+    printf("mix: %d voices  %.2f us per %d-frame block  %.0fx real time\n", kMaxVoices,
+           seconds * 1e6 / blocks, kMixBlockFrames, audioSeconds / seconds);
+    StopMusic(mixer);
+}
+
+// Two seconds of music with an effect every quarter second, for listening
+static void RenderScript(const char* path) {
+    AudioSink* sink = CreateWavFileSink(path);
+    if (sink == NULL) {
+        printf("cannot write %s\n", path);
+        return;
+    }
+    std::vector<short> block(kMixBlockFrames * kMixChannels);
+    int blocks = 2 * kMixRate / kMixBlockFrames;
+    int blocksPerEffect = kMixRate / 4 / kMixBlockFrames;
+    PlayMusic(mixer, SoundGameOver);
+    for (int i = 0; i < blocks; i++) {
+        if (i % blocksPerEffect == 0) {
+            PlaySoundEffect(mixer, soundFiles[(i / blocksPerEffect) % kEffectCount].sound);
+        }
+        MixAudio(mixer, block.data(), kMixBlockFrames);
+        sink->write(block.data(), kMixBlockFrames);
+    }
+    delete sink;
+    printf("wrote %s\n", path);
+}
+
+int main(int argc, char** argv) {
+    int triggers = argc > 1 ? atoi(argv[1]) : 100000;
+    if (triggers <= 0) {
+        printf("Usage: %s [triggers] [out.wav]\n", argv[0]);
+        return 1;
+    }
+
+    LoadSounds();
+    BenchTriggers(triggers);
+    BenchMixing();
+    if (argc > 2) {
+        RenderScript(argv[2]);
+    }
+    return 0;
+}
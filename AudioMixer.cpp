@@ -0,0 +1,239 @@
+#include "AudioMixer.h"
+
+#include <cstdio>
+#include <cstring>
+#include "Logger.h"
+
+void InitAudioMixer(AudioMixer& mixer) {
+    for (int i = 0; i < SoundCount; i++) {
+        mixer.sounds[i].samples.clear();
+        mixer.sounds[i].frameCount = 0;
+    }
+    for (int i = 0; i < kMaxVoices; i++) {
+        mixer.voices[i].sound = NULL;
+        mixer.voices[i].position = 0;
+        mixer.voices[i].looping = false;
+    }
+    mixer.droppedCommands = 0;
+    mixer.mixBuffer.assign(kMixBlockFrames * kMixChannels, 0);
+    mixer.outputBuffer.assign(kMixBlockFrames * kMixChannels, 0);
+    mixer.sink = NULL;
+    mixer.running = false;
+    mixer.framesMixed = 0;
+}
+
+static unsigned int ReadLE(const unsigned char* bytes, int count) {
+    unsigned int value = 0;
+    for (int i = count - 1; i >= 0; i--) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+// Sample of a channel in the file, as 16 bits
+static int SourceSample(const unsigned char* data, int frame, int channel, int channels, int bytesPerSample) {
+    const unsigned char* sample = data + ((size_t)frame * channels + channel) * bytesPerSample;
+    if (bytesPerSample == 1) {
+        return ((int)sample[0] - 128) << 8;  // 8-bit WAV is unsigned
+    }
+    return (short)ReadLE(sample, 2);
+}
+
+bool LoadSound(AudioMixer& mixer, SoundId sound, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    std::vector<unsigned char> bytes;
+    unsigned char chunk[4096];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        bytes.insert(bytes.end(), chunk, chunk + read);
+    }
+    fclose(file);
+
+    if (bytes.size() < 12 || memcmp(&bytes[0], "RIFF", 4) != 0 || memcmp(&bytes[8], "WAVE", 4) != 0) {
+        return false;
+    }
+
+    // Walk the chunks for the format and the samples
+    int format = 0, channels = 0, rate = 0, bitsPerSample = 0;
+    const unsigned char* data = NULL;
+    size_t dataBytes = 0;
+    size_t offset = 12;
+    while (offset + 8 <= bytes.size()) {
+        size_t chunkSize = ReadLE(&bytes[offset + 4], 4);
+        const unsigned char* body = &bytes[offset + 8];
+        size_t available = bytes.size() - offset - 8;
+        if (chunkSize > available) {
+            chunkSize = available;  // Truncated file: use what is there
+        }
+        if (memcmp(&bytes[offset], "fmt ", 4) == 0 && chunkSize >= 16) {
+            format = ReadLE(body, 2);
+            channels = ReadLE(body + 2, 2);
+            rate = ReadLE(body + 4, 4);
+            bitsPerSample = ReadLE(body + 14, 2);
+        }
+        else if (memcmp(&bytes[offset], "data", 4) == 0) {
+            data = body;
+            dataBytes = chunkSize;
+        }
+        offset += 8 + chunkSize + (chunkSize & 1);  // Chunks are padded to an even size
+    }
+
+    int bytesPerSample = bitsPerSample / 8;
+    if (format != 1 || data == NULL || (channels != 1 && channels != 2) || (bitsPerSample != 8 && bitsPerSample != 16) || rate <= 0) {
+        LOG_WARN("Unsupported sound file %s", path);
+        return false;
+    }
+    int sourceFrames = (int)(dataBytes / (channels * bytesPerSample));
+
+    // Convert to the mix format: mono is copied to both channels and the rate
+    // is converted with linear interpolation
+    SoundBuffer& buffer = mixer.sounds[sound];
+    double step = (double)rate / kMixRate;
+    buffer.frameCount = sourceFrames > 0 ? (int)((sourceFrames - 1) / step) + 1 : 0;
+    buffer.samples.resize((size_t)buffer.frameCount * kMixChannels);
+    for (int frame = 0; frame < buffer.frameCount; frame++) {
+        double position = frame * step;
+        int first = (int)position;
+        int second = first + 1 < sourceFrames ? first + 1 : first;
+        double blend = position - first;
+        for (int channel = 0; channel < kMixChannels; channel++) {
+            int sourceChannel = channels == 1 ? 0 : channel;
+            int a = SourceSample(data, first, sourceChannel, channels, bytesPerSample);
+            int b = SourceSample(data, second, sourceChannel, channels, bytesPerSample);
+            buffer.samples[(size_t)frame * kMixChannels + channel] = (short)(a + (b - a) * blend);
+        }
+    }
+    return true;
+}
+
+static void MixingThread(AudioMixer* mixer) {
+    while (mixer->running.load(std::memory_order_acquire)) {
+        MixAudio(*mixer, mixer->outputBuffer.data(), kMixBlockFrames);
+        if (!mixer->sink->write(mixer->outputBuffer.data(), kMixBlockFrames)) {
+            break;  // Device lost: stay silent rather than spin
+        }
+    }
+}
+
+void StartAudioMixer(AudioMixer& mixer, AudioSink* sink) {
+    if (mixer.running) {
+        return;
+    }
+    mixer.sink = sink != NULL ? sink : CreateNullSink(true);
+    mixer.running = true;
+    mixer.thread = std::thread(MixingThread, &mixer);
+}
+
+void StopAudioMixer(AudioMixer& mixer) {
+    if (!mixer.running) {
+        return;
+    }
+    mixer.running = false;
+    mixer.thread.join();
+    delete mixer.sink;
+    mixer.sink = NULL;
+}
+
+static bool QueueCommand(AudioMixer& mixer, AudioCommandType type, SoundId sound) {
+    AudioCommand command;
+    command.type = type;
+    command.sound = sound;
+    if (!mixer.commands.push(command)) {
+        mixer.droppedCommands++;
+        return false;
+    }
+    return true;
+}
+
+bool PlaySoundEffect(AudioMixer& mixer, SoundId sound) {
+    return QueueCommand(mixer, AudioPlayEffect, sound);
+}
+
+bool PlayMusic(AudioMixer& mixer, SoundId sound) {
+    return QueueCommand(mixer, AudioPlayMusic, sound);
+}
+
+bool StopMusic(AudioMixer& mixer) {
+    return QueueCommand(mixer, AudioStopMusic, SoundMusic);
+}
+
+// A free effect voice, or the one that has played the longest if all are busy
+static Voice& PickEffectVoice(AudioMixer& mixer) {
+    int oldest = 1;
+    for (int i = 1; i < kMaxVoices; i++) {
+        if (mixer.voices[i].sound == NULL) {
+            return mixer.voices[i];
+        }
+        if (mixer.voices[i].position > mixer.voices[oldest].position) {
+            oldest = i;
+        }
+    }
+    return mixer.voices[oldest];
+}
+
+static void ApplyCommand(AudioMixer& mixer, const AudioCommand& command) {
+    const SoundBuffer* sound = &mixer.sounds[command.sound];
+    switch (command.type) {
+    case AudioPlayEffect:
+        if (sound->frameCount > 0) {
+            Voice& voice = PickEffectVoice(mixer);
+            voice.sound = sound;
+            voice.position = 0;
+            voice.looping = false;
+        }
+        break;
+    case AudioPlayMusic:
+        mixer.voices[0].sound = sound->frameCount > 0 ? sound : NULL;
+        mixer.voices[0].position = 0;
+        mixer.voices[0].looping = true;
+        break;
+    case AudioStopMusic:
+        mixer.voices[0].sound = NULL;
+        break;
+    }
+}
+
+void MixAudio(AudioMixer& mixer, short* output, int frameCount) {
+    AudioCommand command;
+    while (mixer.commands.pop(command)) {
+        ApplyCommand(mixer, command);
+    }
+
+    int sampleCount = frameCount * kMixChannels;
+    int* mix = mixer.mixBuffer.data();
+    memset(mix, 0, sampleCount * sizeof(int));
+
+    for (int v = 0; v < kMaxVoices; v++) {
+        Voice& voice = mixer.voices[v];
+        int written = 0;
+        while (voice.sound != NULL && written < frameCount) {
+            int available = voice.sound->frameCount - voice.position;
+            int frames = available < frameCount - written ? available : frameCount - written;
+            const short* source = voice.sound->samples.data() + (size_t)voice.position * kMixChannels;
+            int* target = mix + written * kMixChannels;
+            for (int i = 0; i < frames * kMixChannels; i++) {
+                target[i] += source[i];
+            }
+            written += frames;
+            voice.position += frames;
+            if (voice.position == voice.sound->frameCount) {
+                if (voice.looping) {
+                    voice.position = 0;
+                }
+                else {
+                    voice.sound = NULL;  // Finished: the voice is free again
+                }
+            }
+        }
+    }
+
+    // Voices add up; clip rather than wrap around
+    for (int i = 0; i < sampleCount; i++) {
+        int sample = mix[i];
+        output[i] = (short)(sample > 32767 ? 32767 : (sample < -32768 ? -32768 : sample));
+    }
+    mixer.framesMixed.fetch_add(frameCount, std::memory_order_relaxed);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "AudioSink.h"
+#include "SpscQueue.h"
+
+// Software mixer running on its own thread. Sounds are loaded into memory up
+// front; the game thread only queues commands, which never blocks or
+// allocates, and the mixing thread plays them on a fixed pool of voices.
+
+const int kMaxVoices = 16;                   // Voice 0 plays the music, the others effects
+const int kAudioCommandCapacity = 256;       // Commands queued faster than the mixer drains them are dropped
+
+enum SoundId {
+    SoundCoin,
+    SoundObstacle,
+    SoundMagnet,
+    SoundInvincible,
+    SoundGameOver,
+    SoundGameEnd,
+    SoundMusic,
+    SoundCount
+};
+
+// Decoded sound, interleaved stereo at kMixRate. Empty if loading failed.
+struct SoundBuffer {
+    std::vector<short> samples;
+    int frameCount;
+};
+
+enum AudioCommandType {
+    AudioPlayEffect,
+    AudioPlayMusic,
+    AudioStopMusic
+};
+
+struct AudioCommand {
+    AudioCommandType type;
+    SoundId sound;
+};
+
+struct Voice {
+    const SoundBuffer* sound;  // NULL when the voice is free
+    int position;              // Next frame to play
+    bool looping;
+};
+
+struct AudioMixer {
+    SoundBuffer sounds[SoundCount];  // Read-only once the mixer is started
+    SpscQueue<AudioCommand, kAudioCommandCapacity> commands;  // Game thread to mixing thread
+    int droppedCommands;             // Commands lost to a full queue (game thread only)
+
+    // Owned by the mixing thread
+    Voice voices[kMaxVoices];
+    std::vector<int> mixBuffer;      // 32-bit accumulator for one block
+    std::vector<short> outputBuffer;
+    AudioSink* sink;
+
+    std::thread thread;
+    std::atomic<bool> running;
+    std::atomic<long long> framesMixed;
+};
+
+void InitAudioMixer(AudioMixer& mixer);
+
+// Decode a PCM WAV file (8 or 16 bits, mono or stereo, any rate) into a sound
+// slot. Only valid before StartAudioMixer. False if the file is missing or unsupported.
+bool LoadSound(AudioMixer& mixer, SoundId sound, const char* path);
+
+// Start the mixing thread writing to sink, which the mixer then owns. A NULL
+// sink falls back to a real-time null sink.
+void StartAudioMixer(AudioMixer& mixer, AudioSink* sink);
+
+// Stop and join the mixing thread and delete the sink
+void StopAudioMixer(AudioMixer& mixer);
+
+// Game thread: queue a command for the mixing thread. Never blocks; returns
+// false if the queue is full and the command was dropped.
+bool PlaySoundEffect(AudioMixer& mixer, SoundId sound);
+bool PlayMusic(AudioMixer& mixer, SoundId sound);  // Loops on the music voice, replacing the current music
+bool StopMusic(AudioMixer& mixer);
+
+// Apply the queued commands and mix the next frameCount (at most
+// kMixBlockFrames) frames into output. This is what the mixing thread runs;
+// it is exposed so benchmarks can drive the mixer without a thread.
+void MixAudio(AudioMixer& mixer, short* output, int frameCount);
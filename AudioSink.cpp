@@ -0,0 +1,187 @@
+#include "AudioSink.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <mmsystem.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "winmm.lib")
+#endif
+#endif
+
+class NullSink : public AudioSink {
+public:
+    explicit NullSink(bool realTime) : realTime(realTime), framesWritten(0), start(std::chrono::steady_clock::now()) {}
+
+    bool write(const short*, int frameCount) {
+        framesWritten += frameCount;
+        if (realTime) {
+            // Sleep until the audio written so far would have finished playing
+            std::this_thread::sleep_until(start + std::chrono::microseconds(framesWritten * 1000000 / kMixRate));
+        }
+        return true;
+    }
+
+private:
+    bool realTime;
+    long long framesWritten;
+    std::chrono::steady_clock::time_point start;
+};
+
+// WAV files are little-endian
+static void WriteLE(FILE* file, unsigned int value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        fputc((value >> (8 * i)) & 0xFF, file);
+    }
+}
+
+class WavFileSink : public AudioSink {
+public:
+    explicit WavFileSink(FILE* file) : file(file), dataBytes(0) {
+        writeHeader();  // Sizes are patched in when the file is closed
+    }
+
+    ~WavFileSink() {
+        fseek(file, 0, SEEK_SET);
+        writeHeader();
+        fclose(file);
+    }
+
+    bool write(const short* samples, int frameCount) {
+        size_t count = (size_t)frameCount * kMixChannels;
+        for (size_t i = 0; i < count; i++) {
+            WriteLE(file, (unsigned short)samples[i], 2);
+        }
+        dataBytes += (unsigned int)(count * sizeof(short));
+        return !ferror(file);
+    }
+
+private:
+    void writeHeader() {
+        int blockAlign = kMixChannels * 2;
+        fwrite("RIFF", 1, 4, file);
+        WriteLE(file, 36 + dataBytes, 4);
+        fwrite("WAVEfmt ", 1, 8, file);
+        WriteLE(file, 16, 4);  // Format chunk size
+        WriteLE(file, 1, 2);   // PCM
+        WriteLE(file, kMixChannels, 2);
+        WriteLE(file, kMixRate, 4);
+        WriteLE(file, kMixRate * blockAlign, 4);
+        WriteLE(file, blockAlign, 2);
+        WriteLE(file, 16, 2);  // Bits per sample
+        fwrite("data", 1, 4, file);
+        WriteLE(file, dataBytes, 4);
+    }
+
+    FILE* file;
+    unsigned int dataBytes;
+};
+
+AudioSink* CreateNullSink(bool realTime) {
+    return new NullSink(realTime);
+}
+
+AudioSink* CreateWavFileSink(const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return NULL;
+    }
+    return new WavFileSink(file);
+}
+
+#ifdef _WIN32
+
+const int kDeviceBuffers = 3;  // Queued blocks: about 35 ms of latency
+
+// waveOut device fed with a small ring of blocks. write() waits for the oldest
+// block to finish playing before reusing it.
+class WaveOutSink : public AudioSink {
+public:
+    WaveOutSink() : device(NULL), next(0) {
+        memset(headers, 0, sizeof(headers));
+        for (int i = 0; i < kDeviceBuffers; i++) {
+            buffers[i].resize(kMixBlockFrames * kMixChannels);
+        }
+        blockDone = CreateEvent(NULL, FALSE, FALSE, NULL);
+    }
+
+    ~WaveOutSink() {
+        if (device != NULL) {
+            waveOutReset(device);  // Marks every queued block as done
+            for (int i = 0; i < kDeviceBuffers; i++) {
+                if (headers[i].dwFlags & WHDR_PREPARED) {
+                    waveOutUnprepareHeader(device, &headers[i], sizeof(WAVEHDR));
+                }
+            }
+            waveOutClose(device);
+        }
+        if (blockDone != NULL) {
+            CloseHandle(blockDone);
+        }
+    }
+
+    bool open() {
+        if (blockDone == NULL) {
+            return false;
+        }
+        WAVEFORMATEX format = {};
+        format.wFormatTag = WAVE_FORMAT_PCM;
+        format.nChannels = kMixChannels;
+        format.nSamplesPerSec = kMixRate;
+        format.wBitsPerSample = 16;
+        format.nBlockAlign = kMixChannels * 2;
+        format.nAvgBytesPerSec = kMixRate * format.nBlockAlign;
+        return waveOutOpen(&device, WAVE_MAPPER, &format, (DWORD_PTR)blockDone, 0, CALLBACK_EVENT) == MMSYSERR_NOERROR;
+    }
+
+    bool write(const short* samples, int frameCount) {
+        WAVEHDR& header = headers[next];
+        // Blocks finish in order, so the event fires for this one next; earlier
+        // signals only cause an extra check
+        while ((header.dwFlags & WHDR_PREPARED) && !(header.dwFlags & WHDR_DONE)) {
+            WaitForSingleObject(blockDone, INFINITE);
+        }
+        if (header.dwFlags & WHDR_PREPARED) {
+            waveOutUnprepareHeader(device, &header, sizeof(WAVEHDR));
+        }
+
+        memcpy(buffers[next].data(), samples, (size_t)frameCount * kMixChannels * sizeof(short));
+        header.lpData = (LPSTR)buffers[next].data();
+        header.dwBufferLength = frameCount * kMixChannels * sizeof(short);
+        header.dwFlags = 0;
+        if (waveOutPrepareHeader(device, &header, sizeof(WAVEHDR)) != MMSYSERR_NOERROR) {
+            return false;
+        }
+        next = (next + 1) % kDeviceBuffers;
+        return waveOutWrite(device, &header, sizeof(WAVEHDR)) == MMSYSERR_NOERROR;
+    }
+
+private:
+    HWAVEOUT device;
+    HANDLE blockDone;  // Signalled by the driver whenever a block finishes
+    WAVEHDR headers[kDeviceBuffers];
+    std::vector<short> buffers[kDeviceBuffers];
+    int next;  // Block the next write fills
+};
+
+AudioSink* CreateDeviceSink() {
+    WaveOutSink* sink = new WaveOutSink();
+    if (!sink->open()) {
+        delete sink;
+        return NULL;
+    }
+    return sink;
+}
+
+#else
+
+AudioSink* CreateDeviceSink() {
+    return NULL;
+}
+
+#endif
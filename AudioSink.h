@@ -0,0 +1,29 @@
+#pragma once
+
+// Mixer output format. Sounds are converted to it when they are loaded.
+const int kMixRate = 44100;
+const int kMixChannels = 2;       // Interleaved stereo
+const int kMixBlockFrames = 512;  // Frames per mixing pass, about 12 ms
+
+// Where the mixing thread sends its output. write() may block until the
+// destination has room; that is what paces the mixing thread.
+class AudioSink {
+public:
+    virtual ~AudioSink() {}
+
+    // Consume frameCount interleaved frames (at most kMixBlockFrames). False on error.
+    virtual bool write(const short* samples, int frameCount) = 0;
+};
+
+// Discards the samples. With realTime, write() sleeps so the mixer runs at
+// playback speed; without it the mixer runs as fast as it can (benchmarks).
+AudioSink* CreateNullSink(bool realTime);
+
+// Writes a 16-bit PCM WAV file, as fast as the mixer produces it. NULL if the
+// file cannot be created.
+AudioSink* CreateWavFileSink(const char* path);
+
+// The default sound device, or NULL if it cannot be opened. Only Windows
+// (waveOut) has a device sink so far; elsewhere this always returns NULL, the
+// mixer runs against a null sink and the game is silent.
+AudioSink* CreateDeviceSink();
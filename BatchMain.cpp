@@ -0,0 +1,208 @@
+// Batch simulator for difficulty and balance work: plays a large number of
+// independent rounds without a window, spread over all cores by a
+// work-stealing scheduler, and prints how they ended. Round i of a batch is
+// determined by the batch seed and i alone, so the statistics do not depend
+// on the number of threads and a change to a spawn rate, the speed ramp or
+// a power-up duration can be compared against the same set of rounds.
+//
+// Usage: QuickRunnerBatch [--rounds N] [--threads N] [--seed S]
+//                         [--policy idle|scripted|reactive|lookahead] [--miss P]
+// --policy picks who plays (see InputPolicy.h, reactive by default) and
+// --miss how often the reactive player ignores an obstacle.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "GameWorld.h"
+#include "InputPolicy.h"
+#include "WorkStealing.h"
+
+const unsigned int kRoundsPerBatch = 16;  // Rounds a worker takes at a time; a round is 5-300 us
+
+// How a round ended
+enum RoundEnd {
+    EndSurvived,        // The countdown ran out
+    EndGroundObstacle,  // Last life lost to an obstacle on the ground
+    EndAboveObstacle,   // Last life lost to an obstacle above the ground
+    EndCount
+};
+
+const int kScoreBucketPoints = 500;  // Every pickup is worth 500
+const int kScoreBuckets = 128;       // Higher scores count into the last bucket
+const int kSurvivalBuckets = kGameDurationSeconds + 1;  // Whole seconds survived
+
+struct BatchStats {
+    long long rounds;
+    long long totalScore;
+    long long totalTicks;
+    long long groundHits;
+    long long aboveHits;
+    long long ends[EndCount];
+    long long scoreHistogram[kScoreBuckets];
+    long long survivalHistogram[kSurvivalBuckets];
+};
+
+// Everything one thread touches while playing, on its own cache lines
+struct alignas(64) BatchWorker {
+    GameWorld world;
+    InputPolicy policy;
+    BatchStats stats;
+};
+
+struct BatchOptions {
+    unsigned int rounds;
+    int threads;
+    unsigned int seed;
+    PolicyKind policy;
+    float missChance;
+};
+
+// splitmix64 finalizer: decorrelates the seeds of neighbouring rounds
+static unsigned long long MixSeed(unsigned long long value) {
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+static void PlayRound(BatchWorker& worker, const BatchOptions& options, unsigned int round) {
+    unsigned long long roundSeed = MixSeed((unsigned long long)options.seed << 32 | round);
+    GameWorld& world = worker.world;
+    InitGameWorld(world, (unsigned int)roundSeed);
+    InitInputPolicy(worker.policy, options.policy, MixSeed(roundSeed), options.missChance);
+
+    BatchStats& stats = worker.stats;
+    RoundEnd end = EndSurvived;
+    while (!world.gameEnd && !world.gameLose) {
+        StepGameWorld(world, NextPolicyInput(worker.policy, world));
+        for (int i = 0; i < world.eventCount; i++) {
+            if (world.events[i].type == EventHitGroundObstacle) {
+                stats.groundHits++;
+                end = EndGroundObstacle;
+            }
+            else if (world.events[i].type == EventHitAboveObstacle) {
+                stats.aboveHits++;
+                end = EndAboveObstacle;
+            }
+        }
+    }
+
+    stats.rounds++;
+    stats.totalScore += world.score;
+    stats.totalTicks += world.tick;
+    stats.ends[world.gameLose ? end : EndSurvived]++;
+    int bucket = world.score / kScoreBucketPoints;
+    stats.scoreHistogram[bucket < kScoreBuckets ? bucket : kScoreBuckets - 1]++;
+    stats.survivalHistogram[world.tick / kTicksPerSecond]++;
+}
+
+static void MergeStats(BatchStats& total, const BatchStats& stats) {
+    total.rounds += stats.rounds;
+    total.totalScore += stats.totalScore;
+    total.totalTicks += stats.totalTicks;
+    total.groundHits += stats.groundHits;
+    total.aboveHits += stats.aboveHits;
+    for (int i = 0; i < EndCount; i++) {
+        total.ends[i] += stats.ends[i];
+    }
+    for (int i = 0; i < kScoreBuckets; i++) {
+        total.scoreHistogram[i] += stats.scoreHistogram[i];
+    }
+    for (int i = 0; i < kSurvivalBuckets; i++) {
+        total.survivalHistogram[i] += stats.survivalHistogram[i];
+    }
+}
+
+// Smallest bucket that holds at least fraction of the samples
+static int HistogramPercentile(const long long* histogram, int buckets, long long samples, double fraction) {
+    long long seen = 0;
+    for (int i = 0; i < buckets; i++) {
+        seen += histogram[i];
+        if (seen > 0 && seen >= fraction * samples) {
+            return i;
+        }
+    }
+    return buckets - 1;
+}
+
+static void PrintStats(const BatchStats& stats) {
+    double rounds = (double)stats.rounds;
+    const long long* scores = stats.scoreHistogram;
+    const long long* survival = stats.survivalHistogram;
+    printf("score: mean %.0f, p10 %d, p50 %d, p90 %d\n", stats.totalScore / rounds,
+           HistogramPercentile(scores, kScoreBuckets, stats.rounds, 0.1) * kScoreBucketPoints,
+           HistogramPercentile(scores, kScoreBuckets, stats.rounds, 0.5) * kScoreBucketPoints,
+           HistogramPercentile(scores, kScoreBuckets, stats.rounds, 0.9) * kScoreBucketPoints);
+    printf("survival: mean %.1f s, p10 %d s, p50 %d s, p90 %d s\n", stats.totalTicks / rounds / kTicksPerSecond,
+           HistogramPercentile(survival, kSurvivalBuckets, stats.rounds, 0.1),
+           HistogramPercentile(survival, kSurvivalBuckets, stats.rounds, 0.5),
+           HistogramPercentile(survival, kSurvivalBuckets, stats.rounds, 0.9));
+    printf("survived: %.2f%%\n", 100.0 * stats.ends[EndSurvived] / rounds);
+    printf("lost to ground obstacles: %.2f%%\n", 100.0 * stats.ends[EndGroundObstacle] / rounds);
+    printf("lost to above obstacles: %.2f%%\n", 100.0 * stats.ends[EndAboveObstacle] / rounds);
+    printf("hits per round: ground %.3f, above %.3f\n", stats.groundHits / rounds, stats.aboveHits / rounds);
+}
+
+static bool ParseBatchOptions(int argc, char** argv, BatchOptions& options) {
+    options.rounds = 100000;
+    options.threads = DefaultWorkerCount();
+    options.seed = 1;
+    options.policy = PolicyReactive;
+    options.missChance = 0.1f;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            options.rounds = (unsigned int)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc && ParsePolicyKind(argv[i + 1], options.policy)) {
+            i++;
+        }
+        else if (strcmp(argv[i], "--miss") == 0 && i + 1 < argc) {
+            options.missChance = (float)atof(argv[++i]);
+        }
+        else {
+            return false;
+        }
+    }
+    return options.rounds > 0 && options.threads > 0;
+}
+
+int main(int argc, char** argv) {
+    BatchOptions options;
+    if (!ParseBatchOptions(argc, argv, options)) {
+        printf("Usage: %s [--rounds N] [--threads N] [--seed S] [--policy idle|scripted|reactive|lookahead] [--miss P]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<BatchWorker> workers(options.threads);
+    for (BatchWorker& worker : workers) {
+        memset(&worker.stats, 0, sizeof(worker.stats));
+    }
+    auto start = std::chrono::steady_clock::now();
+    RunWorkStealing(options.rounds, options.threads, kRoundsPerBatch, [&](int worker, unsigned int round) {
+        PlayRound(workers[worker], options, round);
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    BatchStats total;
+    memset(&total, 0, sizeof(total));
+    for (const BatchWorker& worker : workers) {
+        MergeStats(total, worker.stats);
+    }
+
+    printf("rounds: %lld\n", total.rounds);
+    printf("policy: %s (miss %.2f)\n", PolicyName(options.policy), options.missChance);
+    printf("seed: %u\n", options.seed);
+    printf("threads: %d\n", options.threads);
+    PrintStats(total);
+    printf("elapsed: %.3f s\n", seconds);
+    printf("rounds/sec: %.0f\n", total.rounds / seconds);
+    printf("ticks/sec: %.0f\n", total.totalTicks / seconds);
+    return 0;
+}
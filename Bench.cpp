@@ -0,0 +1,367 @@
+// CPU benchmark suite for the game's hot paths that need no GL context:
+// whole simulation ticks, level generation, the entity movement and contact
+// window loops, the particle update kernels, spawn / retire churn, the timer
+// wheel, and the shape tessellation and batch building behind DrawHealthBar
+// and DrawEntities, playback of a recorded round and the lookahead bot.
+// FrameBench.cpp covers complete Display() frames. Output format: see
+// BenchRunner.h.
+//
+// Usage: QuickRunnerBench [--runs N] [--filter TEXT] [--output FILE] [--replay FILE]
+#include <cstdlib>
+#include <vector>
+#include "BenchRunner.h"
+#include "EntityKernels.h"
+#include "GameWorld.h"
+#include "InputPolicy.h"
+#include "LevelGenerator.h"
+#include "Replay.h"
+#include "RenderBatch.h"
+#include "ShapeCache.h"
+#include "TimerWheel.h"
+
+// Rounds played back to back from a fixed seed, like HeadlessMain
+static long long SimulateTicks(long long ticks, bool activePlayer) {
+    static GameWorld world;
+    InitGameWorld(world, 1);
+    long long score = 0;
+    unsigned int rounds = 1;
+    for (long long i = 0; i < ticks; i++) {
+        TickInput input = {};
+        if (activePlayer) {
+            input.jumpPressed = i % 37 == 0;
+            input.duckHeld = i % 90 < 30;
+        }
+        StepGameWorld(world, input);
+        if (world.gameEnd || world.gameLose) {
+            score += world.score;
+            InitGameWorld(world, 1 + rounds++);
+        }
+    }
+    return score + world.score;
+}
+
+static void BenchSimulation(const BenchOptions& options) {
+    RunBenchmark(options, "sim.step_idle", "tick", 200000, [](long long ticks) {
+        return SimulateTicks(ticks, false);
+    });
+    RunBenchmark(options, "sim.step_active", "tick", 200000, [](long long ticks) {
+        return SimulateTicks(ticks, true);  // Jumping and ducking: more collisions, pickups and events
+    });
+    RunBenchmark(options, "bot.lookahead", "tick", 20000, [](long long ticks) {  // Planning and stepping
+        static GameWorld world;
+        InitGameWorld(world, 1);
+        long long score = 0;
+        unsigned int rounds = 1;
+        for (long long i = 0; i < ticks; i++) {
+            StepGameWorld(world, PlanLookaheadInput(world));
+            if (world.gameEnd || world.gameLose) {
+                score += world.score;
+                InitGameWorld(world, 1 + rounds++);
+            }
+        }
+        return score + world.score;
+    });
+
+    // Laying out the level, which a ChunkFeed thread does off the tick in the game
+    RunBenchmark(options, "level.generate_chunk", "chunk", 20000, [](long long chunks) {
+        static LevelChunk chunk;
+        LevelGenerator next = StartLevelGenerator(1);
+        long long entries = 0;
+        for (long long i = 0; i < chunks; i++) {
+            GenerateLevelChunk(next, chunk);
+            next = chunk.next;
+            entries += chunk.entryCount;
+        }
+        return entries;
+    });
+
+    // A recorded round, played back whole as often as it fits in the iterations
+    static Replay replay;
+    if (options.replay == NULL) {
+        SkipBenchmark(options, "sim.replay", "no --replay file");
+        return;
+    }
+    if (!LoadReplay(replay, options.replay) || replay.inputs.empty()) {
+        SkipBenchmark(options, "sim.replay", "cannot read the --replay file");
+        return;
+    }
+    static GameWorld world;
+    if (!PlayReplay(replay, world)) {
+        SkipBenchmark(options, "sim.replay", "replay diverged");
+        return;
+    }
+    long long rounds = 200000 / (long long)replay.inputs.size() + 1;
+    RunBenchmark(options, "sim.replay", "tick", rounds * (long long)replay.inputs.size(), [rounds](long long) {
+        long long score = 0;
+        for (long long i = 0; i < rounds; i++) {
+            PlayReplay(replay, world);
+            score += world.score;
+        }
+        return score;
+    });
+}
+
+const int kBenchArchetypeCapacity = 256;  // As large as an arena holds with only X and PrevX
+
+// Archetype filled to capacity with entities evenly spread over -1..1
+static void FillArchetype(EntityStore& store, int archetype) {
+    Archetype& target = store.archetypes[archetype];
+    target.head = 0;
+    target.count = 0;
+    for (int i = 0; i < target.capacity; i++) {
+        PushEntity(store, archetype, -1.0f + 2.0f * i / target.capacity);
+    }
+}
+
+static void BenchEntityLoops(const BenchOptions& options) {
+    // Movement: one scroll pass over a full archetype. The speed is too small
+    // to retire anything, so every pass does the same work.
+    static EntityStore large;
+    ClearEntityStore(large);
+    AddArchetype(large, 0, kBenchArchetypeCapacity);
+    RunBenchmark(options, "entities.scroll_archetype", "entity", 4000 * (long long)kBenchArchetypeCapacity, [](long long entities) {
+        FillArchetype(large, 0);
+        for (long long pass = 0; pass < entities / kBenchArchetypeCapacity; pass++) {
+            ScrollArchetype(large, 0, 1e-9f, -10.0f);
+        }
+        return (long long)large.archetypes[0].count;
+    });
+
+    // The scroll kernels on their own, over a large column
+    struct NamedKernel {
+        const char* name;
+        ScrollKernel kernel;
+        bool supported;
+    };
+    static const NamedKernel kernels[] = {
+        { "entities.scroll_kernel_scalar", ScrollEntitiesScalar, true },
+        { "entities.scroll_kernel_sse2", ScrollEntitiesSSE2, CpuHasSSE2() },
+        { "entities.scroll_kernel_avx2", ScrollEntitiesAVX2, CpuHasAVX2() },
+    };
+    const int columnSize = 1 << 20;
+    static std::vector<float> x(columnSize), prevX(columnSize);
+    for (const NamedKernel& kernel : kernels) {
+        if (!kernel.supported) {
+            SkipBenchmark(options, kernel.name, "unsupported CPU");
+            continue;
+        }
+        ScrollKernel scroll = kernel.kernel;
+        RunBenchmark(options, kernel.name, "entity", 50 * (long long)columnSize, [scroll, columnSize](long long entities) {
+            for (int i = 0; i < columnSize; i++) {
+                x[i] = -1.5f + 3.0f * i / columnSize;
+            }
+            long long below = 0;
+            for (long long pass = 0; pass < entities / columnSize; pass++) {
+                below += scroll(x.data(), prevX.data(), columnSize, 1e-6f, -1.0f);
+            }
+            return below;
+        });
+    }
+
+    // The particle kernels, over a full particle pool. Lives are large enough
+    // that nothing expires, so every pass does the same work.
+    struct NamedParticleKernel {
+        const char* name;
+        ParticleKernel kernel;
+        bool supported;
+    };
+    static const NamedParticleKernel particleKernels[] = {
+        { "particles.update_kernel_scalar", UpdateParticlesScalar, true },
+        { "particles.update_kernel_sse2", UpdateParticlesSSE2, CpuHasSSE2() },
+        { "particles.update_kernel_avx2", UpdateParticlesAVX2, CpuHasAVX2() },
+    };
+    const int poolSize = 1 << 17;
+    static std::vector<float> px(poolSize), py(poolSize), pvx(poolSize), pvy(poolSize), life(poolSize);
+    for (const NamedParticleKernel& kernel : particleKernels) {
+        if (!kernel.supported) {
+            SkipBenchmark(options, kernel.name, "unsupported CPU");
+            continue;
+        }
+        ParticleKernel update = kernel.kernel;
+        RunBenchmark(options, kernel.name, "particle", 200 * (long long)poolSize, [update, poolSize](long long particles) {
+            for (int i = 0; i < poolSize; i++) {
+                px[i] = 0.0f;
+                py[i] = 0.0f;
+                pvx[i] = 0.5f;
+                pvy[i] = 1.0f;
+                life[i] = 1e6f;
+            }
+            long long expired = 0;
+            for (long long pass = 0; pass < particles / poolSize; pass++) {
+                expired += update(px.data(), py.data(), pvx.data(), pvy.data(), life.data(), poolSize, 1e-6f, 1.5f);
+            }
+            return expired;
+        });
+    }
+
+    // Contacts: finding the entities near the player column, for the game's
+    // obstacle archetype and for a much larger one
+    static EntityStore game;
+    ClearEntityStore(game);
+    AddEntityArchetypes(game);
+    RunBenchmark(options, "collisions.window_16", "query", 2000000, [](long long queries) {
+        FillArchetype(game, KindObstacle);
+        long long candidates = 0;
+        for (long long i = 0; i < queries; i++) {
+            int first, end;
+            OverlapRange(game, KindObstacle, kPlayerColumnLeft, kPlayerColumnRight, kObstacleWidth, first, end);
+            candidates += end - first;
+        }
+        return candidates;
+    });
+    RunBenchmark(options, "collisions.window_256", "query", 2000000, [](long long queries) {
+        FillArchetype(large, 0);
+        long long candidates = 0;
+        for (long long i = 0; i < queries; i++) {
+            int first, end;
+            OverlapRange(large, 0, kPlayerColumnLeft, kPlayerColumnRight, kObstacleWidth, first, end);
+            candidates += end - first;
+        }
+        return candidates;
+    });
+
+    // Spawns: spawn a new obstacle and retire the oldest, as a full archetype would
+    RunBenchmark(options, "entities.spawn_churn", "spawn", 2000000, [](long long spawns) {
+        ClearEntities(game);
+        LevelEntry entry = {};
+        entry.kind = KindObstacle;
+        entry.lane = LaneGround;
+        Archetype& obstacles = game.archetypes[KindObstacle];
+        long long pushed = 0;
+        for (long long i = 0; i < spawns; i++) {
+            if (obstacles.count == obstacles.capacity) {
+                PopFrontEntity(obstacles);
+            }
+            pushed += SpawnEntity(game, entry) >= 0;
+        }
+        return pushed;
+    });
+}
+
+static void BenchShapes(const BenchOptions& options) {
+    RunBenchmark(options, "shapes.build_cache", "build", 2000, [](long long builds) {
+        for (long long i = 0; i < builds; i++) {
+            InitShapeCache(DefaultShapeDetail());
+        }
+        return (long long)GetShape(ShapeHeart).count;
+    });
+    InitShapeCache(DefaultShapeDetail());
+
+    // DrawHealthBar: five hearts through the batch. Without a GL context the
+    // batch only builds vertices; nothing is uploaded.
+    static RenderBatch batch;
+    InitRenderBatch(batch);
+    RunBenchmark(options, "batch.health_bar", "heart", 1000000, [](long long hearts) {
+        const Shape& heart = GetShape(ShapeHeart);
+        long long vertices = 0;
+        for (long long i = 0; i < hearts / 5; i++) {
+            BatchReset(batch);
+            BatchPushMatrix(batch);
+            BatchTranslate(batch, -0.9f, 0.8f);
+            for (int life = 0; life < 5; life++) {
+                BatchColor(batch, 1.0f, 0.0f, 0.0f);
+                BatchShape(batch, GL_POLYGON, heart.points, heart.count, life * 0.17f, 0.0f, 0.005f);
+            }
+            BatchPopMatrix(batch);
+            vertices += batch.triangles.size();
+        }
+        return vertices;
+    });
+
+    // DrawCollectibles without instancing: the collectible mesh (disc, ring
+    // and star) expanded through the batch once per collectible
+    static RenderBatch mesh;
+    BatchReset(mesh);
+    const Shape& disc = GetShape(ShapeCollectibleDisc);
+    const Shape& star = GetShape(ShapeCollectibleStar);
+    BatchColor(mesh, 1.0f, 1.0f, 0.0f);
+    BatchShape(mesh, GL_POLYGON, disc.points, disc.count, 0.0f, 0.0f, kCollectibleSize);
+    BatchColor(mesh, 1.0f, 0.8f, 0.0f);
+    BatchShape(mesh, GL_LINE_LOOP, disc.points, disc.count, 0.0f, 0.0f, kCollectibleSize + 0.02f);
+    BatchColor(mesh, 1.0f, 1.0f, 1.0f);
+    BatchShape(mesh, GL_TRIANGLES, star.points, star.count, 0.0f, 0.0f, kCollectibleSize * 0.5f);
+    RunBenchmark(options, "batch.collectibles", "collectible", 1000000, [](long long collectibles) {
+        long long vertices = 0;
+        for (long long i = 0; i < collectibles / 64; i++) {
+            BatchReset(batch);
+            for (int c = 0; c < 64; c++) {
+                BatchPushMatrix(batch);
+                BatchTranslate(batch, -1.0f + c * 0.03f, -0.6f);
+                BatchScale(batch, 1.1f, 1.1f);
+                BatchMesh(batch, mesh.triangles.data(), (int)mesh.triangles.size(), mesh.lines.data(), (int)mesh.lines.size());
+                BatchPopMatrix(batch);
+            }
+            vertices += batch.triangles.size() + batch.lines.size();
+        }
+        return vertices;
+    });
+}
+
+static TimerWheel benchWheel;
+
+// Timer callback counting the timers fired
+static void CountFired(void* context, int) {
+    (*(long long*)context)++;
+}
+
+// Timer callback scheduling itself again payload ticks later, as a repeating
+// effect would
+static void Reschedule(void* context, int payload) {
+    (*(long long*)context)++;
+    ScheduleTimer(benchWheel, payload, Reschedule, payload);
+}
+
+static void BenchTimers(const BenchOptions& options) {
+    // Power-ups picked up and cancelled next to a full wheel's worth of pending effects
+    RunBenchmark(options, "timers.schedule_cancel", "timer", 2000000, [](long long timers) {
+        InitTimerWheel(benchWheel, 0);
+        for (int i = 0; i < kMaxTimers - 1; i++) {
+            ScheduleTimer(benchWheel, 100 + 997 * i, CountFired, 0);
+        }
+        long long cancelled = 0;
+        for (long long i = 0; i < timers; i++) {
+            TimerId timer = ScheduleTimer(benchWheel, kPowerUpDurationTicks + (i & 1023), CountFired, 0);
+            cancelled += CancelTimer(benchWheel, timer);
+        }
+        return cancelled;
+    });
+    // Ticks with every timer pending far ahead: the idle cost, cascades included
+    RunBenchmark(options, "timers.advance_idle", "tick", 20000000, [](long long ticks) {
+        InitTimerWheel(benchWheel, 0);
+        for (int i = 0; i < kMaxTimers; i++) {
+            ScheduleTimer(benchWheel, kMaxTimerDelay - i, CountFired, 0);
+        }
+        long long fired = 0;
+        for (long long i = 0; i < ticks; i++) {
+            AdvanceTimerWheel(benchWheel, &fired);
+        }
+        return fired + benchWheel.pending;
+    });
+    // Ticks with every timer repeating at a different period, up to a few seconds
+    RunBenchmark(options, "timers.advance_firing", "tick", 2000000, [](long long ticks) {
+        InitTimerWheel(benchWheel, 0);
+        for (int i = 0; i < kMaxTimers; i++) {
+            ScheduleTimer(benchWheel, 1 + 7 * i, Reschedule, 1 + 7 * i);
+        }
+        long long fired = 0;
+        for (long long i = 0; i < ticks; i++) {
+            AdvanceTimerWheel(benchWheel, &fired);
+        }
+        return fired;
+    });
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!ParseBenchOptions(argc, argv, options)) {
+        return 1;
+    }
+    BenchSimulation(options);
+    BenchEntityLoops(options);
+    BenchTimers(options);
+    BenchShapes(options);
+    if (options.output != NULL) {
+        fclose(options.output);
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Shared driver for the benchmark programs (Bench.cpp, FrameBench.cpp). Every
+// benchmark gets one untimed warm-up run and then a fixed number of timed
+// runs of the same fixed-seed workload, and is reported as one JSON object per
+// line with the median, fastest and slowest run in nanoseconds per operation:
+//
+//   {"name":"sim.step_idle","op":"tick","iterations":200000,"runs":7,"median_ns":85.1,"min_ns":84.0,"max_ns":90.3}
+//
+// Usage of the programs: [--runs N] [--filter TEXT] [--output FILE] [--replay FILE]
+// --filter runs only benchmarks whose name contains TEXT; --output appends
+// the results to FILE as well as printing them; --replay names a recorded
+// round (Replay.h) for the *.replay benchmarks, which are skipped without one.
+
+struct BenchOptions {
+    int runs;
+    const char* filter;
+    FILE* output;
+    const char* replay;
+};
+
+inline bool ParseBenchOptions(int argc, char** argv, BenchOptions& options) {
+    options.runs = 7;
+    options.filter = NULL;
+    options.output = NULL;
+    options.replay = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            options.runs = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            options.filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            options.output = fopen(argv[++i], "a");
+            if (options.output == NULL) {
+                fprintf(stderr, "Cannot open %s\n", argv[i]);
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            options.replay = argv[++i];
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--runs N] [--filter TEXT] [--output FILE] [--replay FILE]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.runs > 0;
+}
+
+inline bool BenchSelected(const BenchOptions& options, const char* name) {
+    return options.filter == NULL || strstr(name, options.filter) != NULL;
+}
+
+// Print a line to stdout and to the output file, if any
+inline void BenchReport(const BenchOptions& options, const char* line) {
+    fputs(line, stdout);
+    fflush(stdout);
+    if (options.output != NULL) {
+        fputs(line, options.output);
+        fflush(options.output);
+    }
+}
+
+// Results of the benchmark bodies end up here so the work cannot be optimized away
+inline volatile long long benchSink = 0;
+
+// body(iterations) performs iterations operations and returns any value
+// derived from the work
+template <typename Body>
+void RunBenchmark(const BenchOptions& options, const char* name, const char* op, long long iterations, Body body) {
+    if (!BenchSelected(options, name)) {
+        return;
+    }
+    benchSink = benchSink + body(iterations);  // Warm-up: caches, branch predictors, lazy initialization
+
+    std::vector<double> nsPerOp;
+    for (int run = 0; run < options.runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+        benchSink = benchSink + body(iterations);
+        auto end = std::chrono::steady_clock::now();
+        nsPerOp.push_back(std::chrono::duration<double, std::nano>(end - start).count() / iterations);
+    }
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+
+    char line[512];
+    snprintf(line, sizeof(line), "{\"name\":\"%s\",\"op\":\"%s\",\"iterations\":%lld,\"runs\":%d,\"median_ns\":%.3f,\"min_ns\":%.3f,\"max_ns\":%.3f}\n",
+             name, op, iterations, options.runs, nsPerOp[nsPerOp.size() / 2], nsPerOp.front(), nsPerOp.back());
+    BenchReport(options, line);
+}
+
+// Report a benchmark that could not run here
+inline void SkipBenchmark(const BenchOptions& options, const char* name, const char* reason) {
+    if (!BenchSelected(options, name)) {
+        return;
+    }
+    char line[512];
+    snprintf(line, sizeof(line), "{\"name\":\"%s\",\"skipped\":\"%s\"}\n", name, reason);
+    BenchReport(options, line);
+}
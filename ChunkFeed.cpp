@@ -0,0 +1,95 @@
+#include "ChunkFeed.h"
+
+#include <chrono>
+#include "LevelGenerator.h"
+
+// Lay out chunks into the queue from the round's start until running is cleared
+static void FeedRound(ChunkFeed* feed, LevelGenerator next) {
+    static_assert(kChunkFeedCapacity * kLevelChunkTicks >= 4 * kTicksPerSecond, "The feed should run seconds ahead");
+    LevelChunk chunk;
+    bool pending = false;  // chunk is laid out but not queued yet
+    while (feed->running.load(std::memory_order_acquire)) {
+        if (!pending) {
+            GenerateLevelChunk(next, chunk);
+            next = chunk.next;
+            pending = true;
+        }
+        if (feed->chunks.push(chunk)) {
+            pending = false;
+        }
+        else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(kChunkFeedIdleMs));  // Seconds ahead already
+        }
+    }
+}
+
+static void FeedThread(ChunkFeed* feed) {
+    std::unique_lock<std::mutex> lock(feed->mutex);
+    for (;;) {
+        feed->changed.wait(lock, [feed] { return feed->running.load(std::memory_order_relaxed) || feed->exiting; });
+        if (feed->exiting) {
+            return;
+        }
+        LevelGenerator start = feed->start;
+        feed->generating = true;
+        lock.unlock();
+        FeedRound(feed, start);
+        lock.lock();
+        feed->generating = false;
+        feed->changed.notify_all();  // StopChunkFeed may be waiting for the last push
+    }
+}
+
+void InitChunkFeed(ChunkFeed& feed) {
+    feed.running = false;
+    feed.exiting = false;
+    feed.generating = false;
+    feed.world = NULL;
+}
+
+void StartChunkFeed(ChunkFeed& feed, GameWorld& world) {
+    StopChunkFeed(feed);
+    if (!feed.thread.joinable()) {
+        feed.thread = std::thread(FeedThread, &feed);  // Once; later rounds reuse it
+    }
+    // The thread pushes nothing while stopped, so this side may empty the queue
+    LevelChunk stale;
+    while (feed.chunks.pop(stale)) {
+    }
+    feed.world = &world;
+    world.chunkFeed = &feed.chunks;
+    {
+        std::lock_guard<std::mutex> lock(feed.mutex);
+        feed.start = world.level.next;
+        feed.running.store(true, std::memory_order_release);
+    }
+    feed.changed.notify_all();
+}
+
+void StopChunkFeed(ChunkFeed& feed) {
+    {
+        std::unique_lock<std::mutex> lock(feed.mutex);
+        if (!feed.running.load(std::memory_order_relaxed)) {
+            return;
+        }
+        feed.running.store(false, std::memory_order_release);
+        feed.changed.wait(lock, [&feed] { return !feed.generating; });
+    }
+    if (feed.world->chunkFeed == &feed.chunks) {
+        feed.world->chunkFeed = NULL;
+    }
+    feed.world = NULL;
+}
+
+void ShutdownChunkFeed(ChunkFeed& feed) {
+    StopChunkFeed(feed);
+    if (!feed.thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(feed.mutex);
+        feed.exiting = true;
+    }
+    feed.changed.notify_all();
+    feed.thread.join();
+}
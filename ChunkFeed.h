@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "GameWorld.h"
+
+// Thread that lays out the level (LevelGenerator.h) a few chunks ahead of a
+// world and hands the chunks over through a lock-free queue, so the world's
+// ticks only pop ready entities. The chunks are exactly the ones the world
+// would lay out inline, so starting or stopping a feed at any point changes
+// nothing about the round.
+//
+// The thread is created by the first StartChunkFeed and waits between rounds
+// instead of exiting, so starting a round neither creates a thread nor
+// allocates.
+
+const int kChunkFeedIdleMs = 10;  // How long the thread sleeps while the queue is full
+
+struct ChunkFeed {
+    LevelChunkQueue chunks;  // Feed thread to the world's tick
+    std::thread thread;
+    std::atomic<bool> running;  // Laying out chunks for world; the thread polls this while it does
+
+    // The thread waits on changed while it is neither running nor told to exit
+    std::mutex mutex;  // Guards the fields below (and running's changes)
+    std::condition_variable changed;
+    bool exiting;
+    bool generating;  // The thread may still push chunks of the current round
+    LevelGenerator start;  // Where the current round's chunks continue from
+    GameWorld* world;
+};
+
+void InitChunkFeed(ChunkFeed& feed);
+
+// Start generating the chunks that follow the world's current one and attach
+// the feed to the world. Chunks already queued for another round are dropped.
+void StartChunkFeed(ChunkFeed& feed, GameWorld& world);
+
+// Pause the thread and detach the feed from its world, which goes on laying
+// out chunks inline
+void StopChunkFeed(ChunkFeed& feed);
+
+// Stop and join the thread
+void ShutdownChunkFeed(ChunkFeed& feed);
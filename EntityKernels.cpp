@@ -0,0 +1,208 @@
+#include "EntityKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ENTITY_KERNELS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define ENTITY_KERNELS_X86 0
+#endif
+
+// GCC and Clang only accept AVX2 intrinsics in functions compiled for AVX2;
+// MSVC accepts them anywhere
+#if ENTITY_KERNELS_X86 && (defined(__GNUC__) || defined(__clang__))
+#define KERNEL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define KERNEL_TARGET_AVX2
+#endif
+
+#if ENTITY_KERNELS_X86
+
+// A lane that compares true is all ones, i.e. -1 as an integer, so subtracting
+// the comparison result counts the lanes below the limit without branching
+int ScrollEntitiesSSE2(float* x, float* prevX, int count, float speed, float limit) {
+    __m128 speeds = _mm_set1_ps(speed);
+    __m128 limits = _mm_set1_ps(limit);
+    __m128i below = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 values = _mm_loadu_ps(x + i);
+        _mm_storeu_ps(prevX + i, values);
+        values = _mm_sub_ps(values, speeds);
+        _mm_storeu_ps(x + i, values);
+        below = _mm_sub_epi32(below, _mm_castps_si128(_mm_cmplt_ps(values, limits)));
+    }
+
+    int lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, below);
+    int total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return total + ScrollEntitiesScalar(x + i, prevX + i, count - i, speed, limit);
+}
+
+KERNEL_TARGET_AVX2
+int ScrollEntitiesAVX2(float* x, float* prevX, int count, float speed, float limit) {
+    __m256 speeds = _mm256_set1_ps(speed);
+    __m256 limits = _mm256_set1_ps(limit);
+    __m256i below = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 values = _mm256_loadu_ps(x + i);
+        _mm256_storeu_ps(prevX + i, values);
+        values = _mm256_sub_ps(values, speeds);
+        _mm256_storeu_ps(x + i, values);
+        below = _mm256_sub_epi32(below, _mm256_castps_si256(_mm256_cmp_ps(values, limits, _CMP_LT_OQ)));
+    }
+
+    int lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, below);
+    int total = 0;
+    for (int lane = 0; lane < 8; lane++) {
+        total += lanes[lane];
+    }
+    return total + ScrollEntitiesScalar(x + i, prevX + i, count - i, speed, limit);
+}
+
+int UpdateParticlesSSE2(float* x, float* y, const float* vx, float* vy, float* life, int count, float dt, float gravity) {
+    __m128 dts = _mm_set1_ps(dt);
+    __m128 fall = _mm_set1_ps(gravity * dt);
+    __m128 zero = _mm_setzero_ps();
+    __m128i expired = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 velocityY = _mm_sub_ps(_mm_loadu_ps(vy + i), fall);
+        _mm_storeu_ps(vy + i, velocityY);
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(_mm_loadu_ps(vx + i), dts)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(velocityY, dts)));
+        __m128 remaining = _mm_sub_ps(_mm_loadu_ps(life + i), dts);
+        _mm_storeu_ps(life + i, remaining);
+        expired = _mm_sub_epi32(expired, _mm_castps_si128(_mm_cmple_ps(remaining, zero)));
+    }
+
+    int lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, expired);
+    int total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return total + UpdateParticlesScalar(x + i, y + i, vx + i, vy + i, life + i, count - i, dt, gravity);
+}
+
+KERNEL_TARGET_AVX2
+int UpdateParticlesAVX2(float* x, float* y, const float* vx, float* vy, float* life, int count, float dt, float gravity) {
+    __m256 dts = _mm256_set1_ps(dt);
+    __m256 fall = _mm256_set1_ps(gravity * dt);
+    __m256 zero = _mm256_setzero_ps();
+    __m256i expired = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 velocityY = _mm256_sub_ps(_mm256_loadu_ps(vy + i), fall);
+        _mm256_storeu_ps(vy + i, velocityY);
+        _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(_mm256_loadu_ps(vx + i), dts)));
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(velocityY, dts)));
+        __m256 remaining = _mm256_sub_ps(_mm256_loadu_ps(life + i), dts);
+        _mm256_storeu_ps(life + i, remaining);
+        expired = _mm256_sub_epi32(expired, _mm256_castps_si256(_mm256_cmp_ps(remaining, zero, _CMP_LE_OQ)));
+    }
+
+    int lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, expired);
+    int total = 0;
+    for (int lane = 0; lane < 8; lane++) {
+        total += lanes[lane];
+    }
+    return total + UpdateParticlesScalar(x + i, y + i, vx + i, vy + i, life + i, count - i, dt, gravity);
+}
+
+bool CpuHasSSE2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool CpuHasAVX2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;  // OSXSAVE, and XMM + YMM state enabled
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");  // Also checks that the OS saves the YMM registers
+#endif
+}
+
+#else
+
+// Not x86: the vector versions fall back to the scalar loop
+int ScrollEntitiesSSE2(float* x, float* prevX, int count, float speed, float limit) {
+    return ScrollEntitiesScalar(x, prevX, count, speed, limit);
+}
+
+int ScrollEntitiesAVX2(float* x, float* prevX, int count, float speed, float limit) {
+    return ScrollEntitiesScalar(x, prevX, count, speed, limit);
+}
+
+int UpdateParticlesSSE2(float* x, float* y, const float* vx, float* vy, float* life, int count, float dt, float gravity) {
+    return UpdateParticlesScalar(x, y, vx, vy, life, count, dt, gravity);
+}
+
+int UpdateParticlesAVX2(float* x, float* y, const float* vx, float* vy, float* life, int count, float dt, float gravity) {
+    return UpdateParticlesScalar(x, y, vx, vy, life, count, dt, gravity);
+}
+
+bool CpuHasSSE2() {
+    return false;
+}
+
+bool CpuHasAVX2() {
+    return false;
+}
+
+#endif
+
+ScrollKernel BestScrollKernel() {
+    if (CpuHasAVX2()) {
+        return ScrollEntitiesAVX2;
+    }
+    if (CpuHasSSE2()) {
+        return ScrollEntitiesSSE2;
+    }
+    return ScrollEntitiesScalar;
+}
+
+const char* BestScrollKernelName() {
+    if (CpuHasAVX2()) {
+        return "avx2";
+    }
+    if (CpuHasSSE2()) {
+        return "sse2";
+    }
+    return "scalar";
+}
+
+int ScrollEntitiesDispatch(float* x, float* prevX, int count, float speed, float limit) {
+    static const ScrollKernel kernel = BestScrollKernel();  // Picked once, on first use
+    return kernel(x, prevX, count, speed, limit);
+}
+
+ParticleKernel BestParticleKernel() {
+    if (CpuHasAVX2()) {
+        return UpdateParticlesAVX2;
+    }
+    if (CpuHasSSE2()) {
+        return UpdateParticlesSSE2;
+    }
+    return UpdateParticlesScalar;
+}
+
+int UpdateParticlesDispatch(float* x, float* y, const float* vx, float* vy, float* life, int count, float dt, float gravity) {
+    static const ParticleKernel kernel = BestParticleKernel();  // Picked once, on first use
+    return kernel(x, y, vx, vy, life, count, dt, gravity);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+// Vectorized loops over entity and particle columns. Each kernel has a
+// scalar version, an SSE2 and an AVX2 version on x86; the best one for the
+// running CPU is picked on first use.
+
+// Copy x into prevX, move every x left by speed and return how many of the
+// new x values are below limit. count does not have to be a multiple of the
+// vector width.
+typedef int (*ScrollKernel)(float* x, float* prevX, int count, float speed, float limit);
+
+inline int ScrollEntitiesScalar(float* x, float* prevX, int count, float speed, float limit) {
+    int below = 0;
+    for (int i = 0; i < count; i++) {
+        prevX[i] = x[i];
+        x[i] -= speed;
+        below += x[i] < limit;
+    }
+    return below;
+}
+
+int ScrollEntitiesSSE2(float* x, float* prevX, int count, float speed, float limit);
+int ScrollEntitiesAVX2(float* x, float* prevX, int count, float speed, float limit);
+
+bool CpuHasSSE2();
+bool CpuHasAVX2();
+
+// Fastest scroll kernel this CPU supports, and its name for reports
+ScrollKernel BestScrollKernel();
+const char* BestScrollKernelName();
+
+// Runs BestScrollKernel
+int ScrollEntitiesDispatch(float* x, float* prevX, int count, float speed, float limit);
+
+// Entry point for game code. Archetypes usually hold only a handful of
+// entities, so short runs skip the dispatch and use an inlined scalar loop.
+inline int ScrollEntities(float* x, float* prevX, int count, float speed, float limit) {
+    if (count >= 8) {
+        return ScrollEntitiesDispatch(x, prevX, count, speed, limit);
+    }
+    return ScrollEntitiesScalar(x, prevX, count, speed, limit);
+}
+
+// Move count particles along their velocity for dt seconds, pull them down by
+// gravity and age them by dt. Returns how many have no life left (life <= 0).
+typedef int (*ParticleKernel)(float* x, float* y, const float* vx, float* vy, float* life, int count, float dt, float gravity);
+
+inline int UpdateParticlesScalar(float* x, float* y, const float* vx, float* vy, float* life, int count, float dt, float gravity) {
+    int expired = 0;
+    for (int i = 0; i < count; i++) {
+        vy[i] -= gravity * dt;
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        life[i] -= dt;
+        expired += life[i] <= 0.0f;
+    }
+    return expired;
+}
+
+int UpdateParticlesSSE2(float* x, float* y, const float* vx, float* vy, float* life, int count, float dt, float gravity);
+int UpdateParticlesAVX2(float* x, float* y, const float* vx, float* vy, float* life, int count, float dt, float gravity);
+
+// Fastest particle kernel this CPU supports; runs it
+ParticleKernel BestParticleKernel();
+int UpdateParticlesDispatch(float* x, float* y, const float* vx, float* vy, float* life, int count, float dt, float gravity);
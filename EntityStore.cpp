@@ -0,0 +1,66 @@
+#include "EntityStore.h"
+
+// Bytes per entity of each component's column; tags have no column
+static const int kComponentSizes[kComponentCount] = {
+    sizeof(ComponentType<ComponentX>::Type),
+    sizeof(ComponentType<ComponentPrevX>::Type),
+    sizeof(ComponentType<ComponentY>::Type),
+    sizeof(ComponentType<ComponentLane>::Type),
+    sizeof(ComponentType<ComponentWidth>::Type),
+    sizeof(ComponentType<ComponentHeight>::Type),
+    sizeof(ComponentType<ComponentActive>::Type),
+    sizeof(ComponentType<ComponentHasHit>::Type),
+    sizeof(ComponentType<ComponentVariant>::Type),
+    0,
+    0,
+    0,
+};
+
+const int kColumnAlignment = 32;  // Columns start on an AVX vector (and cache line half)
+
+void ClearEntityStore(EntityStore& store) {
+    store.archetypeCount = 0;
+    store.arenaUsed = 0;
+}
+
+int AddArchetype(EntityStore& store, ComponentMask components, int capacity) {
+    if (store.archetypeCount == kMaxArchetypes || capacity <= 0 || (capacity & (capacity - 1)) != 0) {
+        return -1;
+    }
+    components |= ComponentBit(ComponentX) | ComponentBit(ComponentPrevX);
+
+    // Lay the columns out one after the other, each aligned
+    int used = store.arenaUsed;
+    int columns[kComponentCount];
+    for (int c = 0; c < kComponentCount; c++) {
+        columns[c] = -1;
+        if ((components & ComponentBit((Component)c)) == 0 || kComponentSizes[c] == 0) {
+            continue;
+        }
+        used = (used + kColumnAlignment - 1) & ~(kColumnAlignment - 1);
+        columns[c] = used;
+        used += kComponentSizes[c] * capacity;
+    }
+    if (used > kEntityArenaBytes) {
+        return -1;
+    }
+
+    int index = store.archetypeCount++;
+    Archetype& archetype = store.archetypes[index];
+    archetype.components = components;
+    archetype.capacity = capacity;
+    archetype.head = 0;
+    archetype.count = 0;
+    for (int c = 0; c < kComponentCount; c++) {
+        archetype.columns[c] = columns[c];
+    }
+    store.arenaUsed = used;
+    return index;
+}
+
+void ClearEntities(EntityStore& store) {
+    for (int a = 0; a < store.archetypeCount; a++) {
+        store.archetypes[a].head = 0;
+        store.archetypes[a].count = 0;
+    }
+}
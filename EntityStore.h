@@ -0,0 +1,173 @@
+#pragma once
+
+#include "EntityKernels.h"
+
+// Archetype-based entity storage. An entity is a set of components (see
+// Component); all entities with the same set belong to one archetype, which
+// stores them column by column: one contiguous array per component, indexed
+// by the entity's slot. Systems look for the archetypes that have the
+// components they need and run linearly over those columns, so archetypes
+// without them cost one mask test, and a new kind of entity is a new
+// archetype rather than another copy of every loop.
+//
+// Every entity spawns at the right edge and scrolls left at the world's
+// speed, so each archetype is also a ring that stays sorted by x: the oldest
+// entity (front) is always the left-most one. New entities are pushed at the
+// back and off-screen ones are retired from the front, both in O(1). The
+// columns live in an arena inside the store and are addressed by offset, so a
+// store never allocates and copying it (as GameWorld copies are) copies every
+// entity.
+
+// One value per entity each, except the tags, which only mark an archetype
+enum Component {
+    ComponentX,          // float. Every archetype has X and PrevX.
+    ComponentPrevX,      // float: X before the last tick (for render interpolation)
+    ComponentY,          // float
+    ComponentLane,       // unsigned char: EntityLane the entity was spawned in
+    ComponentWidth,      // float: extent right of X that can touch the player
+    ComponentHeight,     // float: top above Y that can touch the player
+    ComponentActive,     // bool: still in play; a collected entity keeps scrolling until it is retired
+    ComponentHasHit,     // bool: already hit the player, so it never hits again
+    ComponentVariant,    // unsigned char: which variant of its kind (power-up type)
+    TagHazard,           // Hurts the player on contact
+    TagScore,            // Scores when picked up
+    TagPowerUp,          // Gives its variant's power-up when picked up
+    kComponentCount
+};
+
+typedef unsigned int ComponentMask;
+
+inline ComponentMask ComponentBit(Component component) {
+    return 1u << component;
+}
+
+// Value type of each component's column
+template <Component C> struct ComponentType;
+template <> struct ComponentType<ComponentX> { typedef float Type; };
+template <> struct ComponentType<ComponentPrevX> { typedef float Type; };
+template <> struct ComponentType<ComponentY> { typedef float Type; };
+template <> struct ComponentType<ComponentLane> { typedef unsigned char Type; };
+template <> struct ComponentType<ComponentWidth> { typedef float Type; };
+template <> struct ComponentType<ComponentHeight> { typedef float Type; };
+template <> struct ComponentType<ComponentActive> { typedef bool Type; };
+template <> struct ComponentType<ComponentHasHit> { typedef bool Type; };
+template <> struct ComponentType<ComponentVariant> { typedef unsigned char Type; };
+
+const int kMaxArchetypes = 8;
+const int kEntityArenaBytes = 3072;  // The game's three archetypes take about 2200
+
+struct Archetype {
+    ComponentMask components;
+    int capacity;                  // Entities it can hold; a power of two
+    int head;                      // Slot of the oldest entity
+    int count;                     // Number of entities
+    int columns[kComponentCount];  // Offset of each component's column in the arena, -1 if it has none
+};
+
+struct EntityStore {
+    Archetype archetypes[kMaxArchetypes];
+    int archetypeCount;
+    int arenaUsed;
+    alignas(32) unsigned char arena[kEntityArenaBytes];
+};
+
+// Remove every archetype and entity
+void ClearEntityStore(EntityStore& store);
+
+// Lay out an archetype with the given components (X and PrevX are always
+// added) for capacity entities. Returns its index, or -1 if kMaxArchetypes
+// exist already or its columns do not fit in the arena.
+int AddArchetype(EntityStore& store, ComponentMask components, int capacity);
+
+// Remove the entities of every archetype, keeping the archetypes
+void ClearEntities(EntityStore& store);
+
+inline bool HasComponents(const Archetype& archetype, ComponentMask components) {
+    return (archetype.components & components) == components;
+}
+
+// The archetype's column of component C. It must have the component.
+template <Component C>
+inline typename ComponentType<C>::Type* Column(EntityStore& store, int archetype) {
+    return (typename ComponentType<C>::Type*)(store.arena + store.archetypes[archetype].columns[C]);
+}
+
+template <Component C>
+inline const typename ComponentType<C>::Type* Column(const EntityStore& store, int archetype) {
+    return (const typename ComponentType<C>::Type*)(store.arena + store.archetypes[archetype].columns[C]);
+}
+
+// Column slot of the i-th entity in spawn order: 0 is the oldest (left-most)
+inline int EntitySlot(const Archetype& archetype, int i) {
+    return (archetype.head + i) & (archetype.capacity - 1);
+}
+
+// Claim the slot for a newly spawned entity at spawnX and return it, or -1
+// (spawning nothing) if the archetype is full. The caller fills in the
+// other components.
+inline int PushEntity(EntityStore& store, int archetype, float spawnX) {
+    Archetype& target = store.archetypes[archetype];
+    if (target.count == target.capacity) {
+        return -1;
+    }
+    int slot = EntitySlot(target, target.count);
+    Column<ComponentX>(store, archetype)[slot] = spawnX;
+    Column<ComponentPrevX>(store, archetype)[slot] = spawnX;
+    target.count++;
+    return slot;
+}
+
+// Retire the oldest entity
+inline void PopFrontEntity(Archetype& archetype) {
+    archetype.head = (archetype.head + 1) & (archetype.capacity - 1);
+    archetype.count--;
+}
+
+// Move every entity of the archetype left by speed and retire the ones that
+// end up left of leftEdge. Those are always the oldest, so one vectorized
+// pass moves the entities and counts them, and retiring them is a single
+// index update.
+inline void ScrollArchetype(EntityStore& store, int archetype, float speed, float leftEdge) {
+    Archetype& target = store.archetypes[archetype];
+    float* x = Column<ComponentX>(store, archetype);
+    float* prevX = Column<ComponentPrevX>(store, archetype);
+
+    // The live slots are at most two contiguous runs: head to the end of the
+    // column, then the part that wrapped around to slot 0
+    int head = target.head;
+    int firstRun = target.count < target.capacity - head ? target.count : target.capacity - head;
+    int leaving = ScrollEntities(x + head, prevX + head, firstRun, speed, leftEdge);
+    leaving += ScrollEntities(x, prevX, target.count - firstRun, speed, leftEdge);
+
+    target.head = (head + leaving) & (target.capacity - 1);
+    target.count -= leaving;
+}
+
+// Number of leading entities (in spawn order) whose x is below value.
+// Binary search, since x increases from the front of the ring to the back.
+inline int CountBelow(const EntityStore& store, int archetype, float value) {
+    const Archetype& target = store.archetypes[archetype];
+    const float* x = Column<ComponentX>(store, archetype);
+    int low = 0;
+    int high = target.count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (x[EntitySlot(target, mid)] < value) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Broadphase: the spawn-order range [first, end) of entities whose span
+// [x, x + extent] may overlap [left, right], found in O(log n). The lower
+// bound is widened by a little slack so float rounding in left - extent never
+// drops an entity; callers apply the exact overlap test to the range.
+inline void OverlapRange(const EntityStore& store, int archetype, float left, float right, float extent, int& first, int& end) {
+    const float slack = 1e-4f;
+    first = CountBelow(store, archetype, left - extent - slack);
+    end = CountBelow(store, archetype, right);
+}
@@ -0,0 +1,35 @@
+#include "FixedTimestep.h"
+
+void InitFixedTimestep(FixedTimestep& timestep, int ticksPerSecond) {
+    timestep.lastTime = std::chrono::steady_clock::now();
+    timestep.accumulator = 0.0;
+    timestep.tickSeconds = 1.0 / ticksPerSecond;
+    timestep.maxTicksPerFrame = ticksPerSecond >= 4 ? ticksPerSecond / 4 : 1;  // Catch up on at most 250 ms at once
+    timestep.droppedTicks = 0;
+}
+
+int AdvanceFixedTimestep(FixedTimestep& timestep) {
+    auto now = std::chrono::steady_clock::now();
+    timestep.accumulator += std::chrono::duration<double>(now - timestep.lastTime).count();
+    timestep.lastTime = now;
+
+    int ticks = (int)(timestep.accumulator / timestep.tickSeconds);
+    timestep.accumulator -= ticks * timestep.tickSeconds;
+
+    // Slow frames are absorbed by running several ticks per frame. Only a stall
+    // longer than maxTicksPerFrame (debugger, window drag) slows the game down,
+    // so the simulation never spirals trying to catch up.
+    if (ticks > timestep.maxTicksPerFrame) {
+        timestep.droppedTicks += ticks - timestep.maxTicksPerFrame;
+        ticks = timestep.maxTicksPerFrame;
+    }
+    return ticks;
+}
+
+std::chrono::steady_clock::time_point FixedTimestepTickTime(const FixedTimestep& timestep) {
+    return timestep.lastTime - std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timestep.accumulator));
+}
+
+double FixedTimestepWait(const FixedTimestep& timestep) {
+    return timestep.tickSeconds - timestep.accumulator;
+}
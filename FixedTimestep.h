@@ -0,0 +1,27 @@
+#pragma once
+
+#include <chrono>
+
+// Fixed-timestep accumulator on the monotonic clock. Real time is converted
+// into a whole number of simulation ticks; the remainder is kept for the next
+// frame, and the renderer interpolates by it (see FixedTimestepTickTime).
+struct FixedTimestep {
+    std::chrono::steady_clock::time_point lastTime;  // When the accumulator was last advanced
+    double accumulator;        // Real time (seconds) not yet simulated
+    double tickSeconds;        // Length of one simulation tick
+    int maxTicksPerFrame;      // Upper bound on catch-up after a long stall
+    long droppedTicks;         // Ticks discarded because of that bound
+};
+
+void InitFixedTimestep(FixedTimestep& timestep, int ticksPerSecond);
+
+// Add the real time elapsed since the previous call and return how many
+// ticks should be simulated now
+int AdvanceFixedTimestep(FixedTimestep& timestep);
+
+// Real time at which the last simulated tick was due. A thread that draws
+// ticks simulated by another one interpolates from this.
+std::chrono::steady_clock::time_point FixedTimestepTickTime(const FixedTimestep& timestep);
+
+// Seconds until the next tick is due
+double FixedTimestepWait(const FixedTimestep& timestep);
@@ -0,0 +1,105 @@
+// Benchmark of complete game frames (RenderGameFrame, i.e. Display() without
+// the buffer swap) in an offscreen 800x600 EGL context, so it runs without a
+// window or display server. HUD text is off because GLUT's fonts need a
+// window. Output format: see BenchRunner.h.
+//
+// Usage: FrameBench [--runs N] [--filter TEXT] [--output FILE] [--replay FILE]
+#include "BenchRunner.h"
+#include "GLIncludes.h"
+#include "OffscreenContext.h"
+#include "ParticleSystem.h"
+#include "QuickRunnerIO.h"
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!ParseBenchOptions(argc, argv, options)) {
+        return 1;
+    }
+    if (!CreateOffscreenContext(800, 600)) {
+        SkipBenchmark(options, "frame.display", "no offscreen EGL context");
+        SkipBenchmark(options, "frame.play", "no offscreen EGL context");
+        SkipBenchmark(options, "frame.replay", "no offscreen EGL context");
+        SkipBenchmark(options, "frame.particles_100k", "no offscreen EGL context");
+        SkipBenchmark(options, "frame.particles_100k_points", "no offscreen EGL context");
+        return 0;
+    }
+    InitializeGame(false);
+
+    // The same scene drawn again and again: ten seconds into a seeded round
+    RunBenchmark(options, "frame.display", "frame", 300, [](long long frames) {
+        RestartGame(1);
+        RunGameTicks(600);
+        for (long long i = 0; i < frames; i++) {
+            RenderGameFrame();
+        }
+        glFinish();  // Count the GPU work too
+        return 0LL;
+    });
+
+    // Playing: one simulation tick per frame, as at 60 frames per second
+    RunBenchmark(options, "frame.play", "frame", 300, [](long long frames) {
+        RestartGame(1);
+        for (long long i = 0; i < frames; i++) {
+            RunGameTicks(1);
+            RenderGameFrame();
+        }
+        glFinish();
+        return 0LL;
+    });
+
+    // A recorded round rendered one tick per frame, from the start of the round
+    if (options.replay == NULL) {
+        SkipBenchmark(options, "frame.replay", "no --replay file");
+    }
+    else if (!StartReplay(options.replay)) {
+        SkipBenchmark(options, "frame.replay", "cannot read the --replay file");
+    }
+    else {
+        RunBenchmark(options, "frame.replay", "frame", 300, [&options](long long frames) {
+            StartReplay(options.replay);
+            for (long long i = 0; i < frames; i++) {
+                RunGameTicks(1);
+                RenderGameFrame();
+            }
+            glFinish();
+            return 0LL;
+        });
+    }
+
+    // Worst case for the particle pass: the game's frame with about 100k
+    // sparks alive on top, topped up by fresh bursts every frame. The _points
+    // variant forces one point per particle even where DrawParticles would
+    // add them up into a layer (software renderers).
+    static ParticleSystem particles;
+    InitParticleSystem(particles);
+    auto particleFrames = [](long long frames) {
+        RestartGame(1);
+        RunGameTicks(600);
+        ClearParticles(particles);
+        ParticleBurst burst = { EffectHit, 0.0f, 0.0f, 0.0f, 0 };
+        long long live = 0;
+        for (long long i = 0; i < frames; i++) {
+            for (int b = 0; particles.count < 100000; b++) {
+                burst.x = -0.9f + 0.0018f * (b % 1000);
+                burst.y = -0.5f + 0.1f * (b % 10);
+                EmitParticles(particles, burst);
+            }
+            UpdateParticles(particles, 1.0f / 60.0f);
+            RenderGameFrame();
+            DrawParticles(particles);
+            live += particles.count;
+        }
+        glFinish();
+        return live;
+    };
+    RunBenchmark(options, "frame.particles_100k", "frame", 300, particleFrames);
+    bool useLayer = particles.useLayer;
+    particles.useLayer = false;
+    RunBenchmark(options, "frame.particles_100k_points", "frame", 60, particleFrames);
+    particles.useLayer = useLayer;
+
+    if (options.output != NULL) {
+        fclose(options.output);
+    }
+    return 0;
+}
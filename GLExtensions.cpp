@@ -0,0 +1,108 @@
+#include "GLExtensions.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <GL/glx.h>
+#endif
+
+GLExtensions glExt;
+
+// Look up a GL entry point, trying the core name first and then the ARB one
+// (arbName may be NULL when the ARB version has a different signature)
+static void* GetGLProc(const char* name, const char* arbName) {
+#ifdef _WIN32
+    void* proc = (void*)wglGetProcAddress(name);
+    if (proc == NULL && arbName != NULL) {
+        proc = (void*)wglGetProcAddress(arbName);
+    }
+#else
+    void* proc = (void*)glXGetProcAddressARB((const GLubyte*)name);
+    if (proc == NULL && arbName != NULL) {
+        proc = (void*)glXGetProcAddressARB((const GLubyte*)arbName);
+    }
+#endif
+    return proc;
+}
+
+// glXGetProcAddress returns non-null for any name, so also check the version
+static bool HasGLVersion(int major, int minor) {
+    const char* version = (const char*)glGetString(GL_VERSION);
+    if (version == NULL) {
+        return false;
+    }
+    int versionMajor = version[0] - '0';
+    int versionMinor = version[2] - '0';
+    return versionMajor > major || (versionMajor == major && versionMinor >= minor);
+}
+
+static bool HasGLExtension(const char* name) {
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    size_t length = strlen(name);
+    for (const char* found = extensions; found != NULL && (found = strstr(found, name)) != NULL; found += length) {
+        if ((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == '\0')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void LoadGLExtensions() {
+    glExt.GenBuffers = (void (GLEXT_APIENTRY*)(GLsizei, GLuint*))GetGLProc("glGenBuffers", "glGenBuffersARB");
+    glExt.DeleteBuffers = (void (GLEXT_APIENTRY*)(GLsizei, const GLuint*))GetGLProc("glDeleteBuffers", "glDeleteBuffersARB");
+    glExt.BindBuffer = (void (GLEXT_APIENTRY*)(GLenum, GLuint))GetGLProc("glBindBuffer", "glBindBufferARB");
+    glExt.BufferData = (void (GLEXT_APIENTRY*)(GLenum, ptrdiff_t, const void*, GLenum))GetGLProc("glBufferData", "glBufferDataARB");
+    glExt.BufferSubData = (void (GLEXT_APIENTRY*)(GLenum, ptrdiff_t, ptrdiff_t, const void*))GetGLProc("glBufferSubData", "glBufferSubDataARB");
+    glExt.hasVertexBuffers = HasGLVersion(1, 5) && glExt.GenBuffers && glExt.DeleteBuffers && glExt.BindBuffer && glExt.BufferData && glExt.BufferSubData;
+
+    // The ARB_shader_objects names use handles instead of GLuint, so only the core names are loaded
+    glExt.CreateShader = (GLuint (GLEXT_APIENTRY*)(GLenum))GetGLProc("glCreateShader", NULL);
+    glExt.ShaderSource = (void (GLEXT_APIENTRY*)(GLuint, GLsizei, const char* const*, const GLint*))GetGLProc("glShaderSource", NULL);
+    glExt.CompileShader = (void (GLEXT_APIENTRY*)(GLuint))GetGLProc("glCompileShader", NULL);
+    glExt.GetShaderiv = (void (GLEXT_APIENTRY*)(GLuint, GLenum, GLint*))GetGLProc("glGetShaderiv", NULL);
+    glExt.GetShaderInfoLog = (void (GLEXT_APIENTRY*)(GLuint, GLsizei, GLsizei*, char*))GetGLProc("glGetShaderInfoLog", NULL);
+    glExt.DeleteShader = (void (GLEXT_APIENTRY*)(GLuint))GetGLProc("glDeleteShader", NULL);
+    glExt.CreateProgram = (GLuint (GLEXT_APIENTRY*)())GetGLProc("glCreateProgram", NULL);
+    glExt.AttachShader = (void (GLEXT_APIENTRY*)(GLuint, GLuint))GetGLProc("glAttachShader", NULL);
+    glExt.BindAttribLocation = (void (GLEXT_APIENTRY*)(GLuint, GLuint, const char*))GetGLProc("glBindAttribLocation", NULL);
+    glExt.LinkProgram = (void (GLEXT_APIENTRY*)(GLuint))GetGLProc("glLinkProgram", NULL);
+    glExt.GetProgramiv = (void (GLEXT_APIENTRY*)(GLuint, GLenum, GLint*))GetGLProc("glGetProgramiv", NULL);
+    glExt.GetProgramInfoLog = (void (GLEXT_APIENTRY*)(GLuint, GLsizei, GLsizei*, char*))GetGLProc("glGetProgramInfoLog", NULL);
+    glExt.UseProgram = (void (GLEXT_APIENTRY*)(GLuint))GetGLProc("glUseProgram", NULL);
+    glExt.VertexAttribPointer = (void (GLEXT_APIENTRY*)(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*))GetGLProc("glVertexAttribPointer", "glVertexAttribPointerARB");
+    glExt.EnableVertexAttribArray = (void (GLEXT_APIENTRY*)(GLuint))GetGLProc("glEnableVertexAttribArray", "glEnableVertexAttribArrayARB");
+    glExt.DisableVertexAttribArray = (void (GLEXT_APIENTRY*)(GLuint))GetGLProc("glDisableVertexAttribArray", "glDisableVertexAttribArrayARB");
+    glExt.hasShaders = HasGLVersion(2, 0) && glExt.CreateShader && glExt.ShaderSource && glExt.CompileShader && glExt.GetShaderiv &&
+        glExt.GetShaderInfoLog && glExt.DeleteShader && glExt.CreateProgram && glExt.AttachShader && glExt.BindAttribLocation &&
+        glExt.LinkProgram && glExt.GetProgramiv && glExt.GetProgramInfoLog && glExt.UseProgram && glExt.VertexAttribPointer &&
+        glExt.EnableVertexAttribArray && glExt.DisableVertexAttribArray;
+
+    // Below 3.3 only the ARB names are guaranteed to point at a real implementation
+    bool coreInstancing = HasGLVersion(3, 3);
+    bool arbInstancing = HasGLExtension("GL_ARB_instanced_arrays") && HasGLExtension("GL_ARB_draw_instanced");
+    glExt.VertexAttribDivisor = (void (GLEXT_APIENTRY*)(GLuint, GLuint))(coreInstancing ?
+        GetGLProc("glVertexAttribDivisor", "glVertexAttribDivisorARB") : GetGLProc("glVertexAttribDivisorARB", NULL));
+    glExt.DrawArraysInstanced = (void (GLEXT_APIENTRY*)(GLenum, GLint, GLsizei, GLsizei))(coreInstancing ?
+        GetGLProc("glDrawArraysInstanced", "glDrawArraysInstancedARB") : GetGLProc("glDrawArraysInstancedARB", NULL));
+    glExt.hasInstancing = glExt.hasShaders && (coreInstancing || arbInstancing) && glExt.VertexAttribDivisor && glExt.DrawArraysInstanced;
+
+    // ARB_framebuffer_object uses the core names; the older EXT version has
+    // the same signatures and enum values under its own names
+    bool coreFramebuffers = HasGLVersion(3, 0) || HasGLExtension("GL_ARB_framebuffer_object");
+    bool extFramebuffers = HasGLExtension("GL_EXT_framebuffer_object");
+    glExt.GenFramebuffers = (void (GLEXT_APIENTRY*)(GLsizei, GLuint*))GetGLProc(coreFramebuffers ? "glGenFramebuffers" : "glGenFramebuffersEXT", NULL);
+    glExt.DeleteFramebuffers = (void (GLEXT_APIENTRY*)(GLsizei, const GLuint*))GetGLProc(coreFramebuffers ? "glDeleteFramebuffers" : "glDeleteFramebuffersEXT", NULL);
+    glExt.BindFramebuffer = (void (GLEXT_APIENTRY*)(GLenum, GLuint))GetGLProc(coreFramebuffers ? "glBindFramebuffer" : "glBindFramebufferEXT", NULL);
+    glExt.FramebufferTexture2D = (void (GLEXT_APIENTRY*)(GLenum, GLenum, GLenum, GLuint, GLint))GetGLProc(
+        coreFramebuffers ? "glFramebufferTexture2D" : "glFramebufferTexture2DEXT", NULL);
+    glExt.CheckFramebufferStatus = (GLenum (GLEXT_APIENTRY*)(GLenum))GetGLProc(coreFramebuffers ? "glCheckFramebufferStatus" : "glCheckFramebufferStatusEXT", NULL);
+    glExt.hasFramebuffers = (coreFramebuffers || extFramebuffers) && glExt.GenFramebuffers && glExt.DeleteFramebuffers &&
+        glExt.BindFramebuffer && glExt.FramebufferTexture2D && glExt.CheckFramebufferStatus;
+
+    // Mesa's llvmpipe and softpipe, and Windows' own GDI Generic
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+    glExt.isSoftwareRenderer = renderer != NULL && (strstr(renderer, "llvmpipe") != NULL || strstr(renderer, "softpipe") != NULL ||
+        strstr(renderer, "GDI Generic") != NULL);
+}
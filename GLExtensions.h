@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include "GLIncludes.h"
+
+// OpenGL entry points newer than 1.1 are not exported by opengl32.lib on
+// Windows and have to be looked up at runtime once a context exists. Only the
+// functions the renderer uses are listed here.
+
+// glut.h undefines APIENTRY again at its end, so use our own calling convention
+#ifdef _WIN32
+#define GLEXT_APIENTRY __stdcall
+#else
+#define GLEXT_APIENTRY
+#endif
+
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+#ifndef GL_STATIC_DRAW
+#define GL_STATIC_DRAW 0x88E4
+#endif
+#ifndef GL_FRAGMENT_SHADER
+#define GL_FRAGMENT_SHADER 0x8B30
+#endif
+#ifndef GL_VERTEX_SHADER
+#define GL_VERTEX_SHADER 0x8B31
+#endif
+#ifndef GL_COMPILE_STATUS
+#define GL_COMPILE_STATUS 0x8B81
+#endif
+#ifndef GL_LINK_STATUS
+#define GL_LINK_STATUS 0x8B82
+#endif
+#ifndef GL_FRAMEBUFFER
+#define GL_FRAMEBUFFER 0x8D40
+#endif
+#ifndef GL_COLOR_ATTACHMENT0
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#endif
+#ifndef GL_FRAMEBUFFER_COMPLETE
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#endif
+
+struct GLExtensions {
+    bool hasVertexBuffers;     // OpenGL 1.5 / ARB_vertex_buffer_object
+    bool hasShaders;           // OpenGL 2.0 (GLSL 1.10)
+    bool hasInstancing;        // OpenGL 3.3 / ARB_instanced_arrays + ARB_draw_instanced
+    bool hasFramebuffers;      // OpenGL 3.0 / ARB_framebuffer_object / EXT_framebuffer_object
+    bool isSoftwareRenderer;   // Rasterizes on the CPU, where every primitive has a high fixed cost
+
+    void (GLEXT_APIENTRY* GenBuffers)(GLsizei n, GLuint* buffers);
+    void (GLEXT_APIENTRY* DeleteBuffers)(GLsizei n, const GLuint* buffers);
+    void (GLEXT_APIENTRY* BindBuffer)(GLenum target, GLuint buffer);
+    void (GLEXT_APIENTRY* BufferData)(GLenum target, ptrdiff_t size, const void* data, GLenum usage);
+    void (GLEXT_APIENTRY* BufferSubData)(GLenum target, ptrdiff_t offset, ptrdiff_t size, const void* data);
+
+    GLuint (GLEXT_APIENTRY* CreateShader)(GLenum type);
+    void (GLEXT_APIENTRY* ShaderSource)(GLuint shader, GLsizei count, const char* const* strings, const GLint* lengths);
+    void (GLEXT_APIENTRY* CompileShader)(GLuint shader);
+    void (GLEXT_APIENTRY* GetShaderiv)(GLuint shader, GLenum name, GLint* value);
+    void (GLEXT_APIENTRY* GetShaderInfoLog)(GLuint shader, GLsizei size, GLsizei* length, char* log);
+    void (GLEXT_APIENTRY* DeleteShader)(GLuint shader);
+    GLuint (GLEXT_APIENTRY* CreateProgram)();
+    void (GLEXT_APIENTRY* AttachShader)(GLuint program, GLuint shader);
+    void (GLEXT_APIENTRY* BindAttribLocation)(GLuint program, GLuint index, const char* name);
+    void (GLEXT_APIENTRY* LinkProgram)(GLuint program);
+    void (GLEXT_APIENTRY* GetProgramiv)(GLuint program, GLenum name, GLint* value);
+    void (GLEXT_APIENTRY* GetProgramInfoLog)(GLuint program, GLsizei size, GLsizei* length, char* log);
+    void (GLEXT_APIENTRY* UseProgram)(GLuint program);
+    void (GLEXT_APIENTRY* VertexAttribPointer)(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+    void (GLEXT_APIENTRY* EnableVertexAttribArray)(GLuint index);
+    void (GLEXT_APIENTRY* DisableVertexAttribArray)(GLuint index);
+
+    void (GLEXT_APIENTRY* VertexAttribDivisor)(GLuint index, GLuint divisor);
+    void (GLEXT_APIENTRY* DrawArraysInstanced)(GLenum mode, GLint first, GLsizei count, GLsizei instances);
+
+    void (GLEXT_APIENTRY* GenFramebuffers)(GLsizei n, GLuint* framebuffers);
+    void (GLEXT_APIENTRY* DeleteFramebuffers)(GLsizei n, const GLuint* framebuffers);
+    void (GLEXT_APIENTRY* BindFramebuffer)(GLenum target, GLuint framebuffer);
+    void (GLEXT_APIENTRY* FramebufferTexture2D)(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level);
+    GLenum (GLEXT_APIENTRY* CheckFramebufferStatus)(GLenum target);
+};
+
+extern GLExtensions glExt;
+
+// Look up the extension entry points. Requires a current GL context.
+void LoadGLExtensions();
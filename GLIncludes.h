@@ -0,0 +1,11 @@
+#pragma once
+
+// GLUT, and through it GL and GLU. Windows builds use the GLUT 3.7 header
+// kept next to the sources (with glut32.lib); elsewhere the system's GLUT
+// (freeglut) is used.
+#include <cstdlib>  // Before glut.h, which redeclares exit()
+#ifdef _WIN32
+#include <glut.h>
+#else
+#include <GL/glut.h>
+#endif
@@ -0,0 +1,367 @@
+#include "GameWorld.h"
+
+#include <cstddef>
+#include "LevelGenerator.h"
+
+// Record an event for the front end; silently dropped if the tick is already full
+static void PushEvent(GameWorld& world, GameEventType type, float x, float y) {
+    if (world.eventCount < kMaxEventsPerTick) {
+        GameEvent& event = world.events[world.eventCount++];
+        event.type = type;
+        event.x = x;
+        event.y = y;
+    }
+}
+
+void InitGameWorld(GameWorld& world, unsigned int seed) {
+    world.tick = 0;
+    world.seed = seed;
+    world.playerX = -0.8f;        // Starting X position for the player
+    world.playerY = 0.0f;
+    world.prevPlayerX = world.playerX;
+    world.prevPlayerY = world.playerY;
+    world.isJumping = false;
+    world.isDucking = false;
+    world.jumpVelocity = 0.05f;
+    world.gravity = 0.002f;
+    world.gameSpeed = kStartGameSpeed;
+    world.distance = 0.0f;
+    world.lives = 5;
+    world.score = 0;
+    world.gameTime = kGameDurationSeconds;
+    world.hasMagnet = false;
+    world.isInvincible = false;
+    world.magnetTimer = kNoTimer;
+    world.invincibilityTimer = kNoTimer;
+    world.isKnockedBack = false;
+    world.isReadjusting = false;
+    world.readjustSpeed = 0.01f;
+    world.knockbackStrength = 0.02f;
+    world.knockbackDuration = 30;
+    world.knockbackTimer = kNoTimer;
+    world.gameEnd = false;
+    world.gameLose = false;
+    ClearEntityStore(world.entities);
+    AddEntityArchetypes(world.entities);
+    world.eventCount = 0;
+    InitTimerWheel(world.timers, world.tick);
+
+    // An empty chunk that ends before the first tick, so that tick lays out
+    // or fetches the first real one
+    world.level.firstTick = 0;
+    world.level.endTick = 0;
+    world.level.entryCount = 0;
+    world.level.next = StartLevelGenerator(seed);
+    world.nextEntry = 0;
+    world.chunkFeed = NULL;
+}
+
+// Make the chunk that contains this tick current: the next one from the
+// feed, or laid out right here when there is no feed or it has none ready
+// (just started, stopped or starved). Chunks are the same either way, so the
+// feed's copies of chunks laid out here end before this tick and the loop
+// steps past them when they turn up.
+static void AdvanceLevel(GameWorld& world) {
+    while (world.tick >= world.level.endTick) {
+        if (world.chunkFeed == NULL || !world.chunkFeed->pop(world.level)) {
+            LevelGenerator next = world.level.next;
+            GenerateLevelChunk(next, world.level);
+        }
+        world.nextEntry = 0;
+    }
+}
+
+void AddEntityArchetypes(EntityStore& store) {
+    for (int kind = 0; kind < kEntityKindCount; kind++) {
+        AddArchetype(store, kEntityKinds[kind].components, kEntityKinds[kind].capacity);
+    }
+}
+
+int SpawnEntity(EntityStore& store, const LevelEntry& entry) {
+    int kind = entry.kind;
+    const EntityKindInfo& info = kEntityKinds[kind];
+    int slot = PushEntity(store, kind, 1.0f);  // At the right edge of the screen
+    if (slot < 0) {
+        return -1;
+    }
+    ComponentMask components = store.archetypes[kind].components;
+    if (components & ComponentBit(ComponentY)) {
+        Column<ComponentY>(store, kind)[slot] = info.y[entry.lane];
+    }
+    if (components & ComponentBit(ComponentLane)) {
+        Column<ComponentLane>(store, kind)[slot] = entry.lane;
+    }
+    if (components & ComponentBit(ComponentWidth)) {
+        Column<ComponentWidth>(store, kind)[slot] = info.width;
+    }
+    if (components & ComponentBit(ComponentHeight)) {
+        Column<ComponentHeight>(store, kind)[slot] = info.height[entry.lane];
+    }
+    if (components & ComponentBit(ComponentActive)) {
+        Column<ComponentActive>(store, kind)[slot] = true;
+    }
+    if (components & ComponentBit(ComponentHasHit)) {
+        Column<ComponentHasHit>(store, kind)[slot] = false;
+    }
+    if (components & ComponentBit(ComponentVariant)) {
+        Column<ComponentVariant>(store, kind)[slot] = entry.variant;
+    }
+    return slot;
+}
+
+// Spawn system: this tick's level entries, each into its kind's archetype
+static void SpawnDue(GameWorld& world) {
+    const LevelChunk& level = world.level;
+    while (world.nextEntry < level.entryCount && level.entries[world.nextEntry].tick == world.tick) {
+        SpawnEntity(world.entities, level.entries[world.nextEntry]);
+        world.nextEntry++;
+    }
+}
+
+// Movement system: every archetype scrolls towards the player, retiring the
+// entities that went off-screen. Collected entities keep moving with the
+// others so each ring stays sorted by x; entities leave the screen in spawn
+// order, so only the front can be off-screen, and collected ones are retired
+// as soon as they reach the front.
+static void MoveEntities(GameWorld& world) {
+    EntityStore& store = world.entities;
+    for (int a = 0; a < store.archetypeCount; a++) {
+        ScrollArchetype(store, a, world.gameSpeed, -1.0f);
+        Archetype& archetype = store.archetypes[a];
+        if (HasComponents(archetype, ComponentBit(ComponentActive))) {
+            const bool* active = Column<ComponentActive>(store, a);
+            while (archetype.count > 0 && !active[archetype.head]) {
+                PopFrontEntity(archetype);
+            }
+        }
+    }
+}
+
+// Function to handle jumping mechanics with speed adjustments
+static void JumpMechanics(GameWorld& world) {
+    if (world.isJumping) {
+        world.playerY += world.jumpVelocity * world.gameSpeed * 100;  // Move the player upwards faster as gameSpeed increases
+        world.jumpVelocity -= world.gravity * world.gameSpeed * 50;   // Apply stronger gravity over time
+
+        // Check if the player lands back on the ground
+        if (world.playerY <= 0.0f) {  // Player has landed back
+            world.playerY = 0.0f;      // Reset to ground level (relative to -0.7f in DrawPlayer)
+            world.isJumping = false;   // Stop jumping
+            world.jumpVelocity = 0.05f; // Reset jump velocity
+        }
+    }
+}
+
+// Exact test for an entity spanning [x, x + width] against the player column
+static bool OverlapsPlayerColumn(float x, float width) {
+    return kPlayerColumnLeft < x + width && kPlayerColumnRight > x;
+}
+
+// Score pickup (TagScore) touching the player
+static void TouchScore(GameWorld& world, int archetype, int s) {
+    EntityStore& store = world.entities;
+    float x = Column<ComponentX>(store, archetype)[s];
+    float y = Column<ComponentY>(store, archetype)[s];
+    bool* active = Column<ComponentActive>(store, archetype);
+    if (world.hasMagnet) {
+        world.score += 500;
+        active[s] = false;
+        PushEvent(world, EventCollectedWithMagnet, x, y);
+        return;
+    }
+    if (Column<ComponentLane>(store, archetype)[s] == LaneGround && world.playerY <= 0.1f) {
+        world.score += 500;
+        active[s] = false;
+        PushEvent(world, EventCollectedGround, x, y);
+    }
+    else if (world.playerY >= y + 0.5f) {
+        world.score += 500;
+        active[s] = false;
+        PushEvent(world, EventCollectedHigh, x, y);
+    }
+}
+
+// Timer callback ending the power-up of the given type
+static void EndPowerUp(void* context, int type) {
+    GameWorld& world = *(GameWorld*)context;
+    if (type == 1) {
+        world.hasMagnet = false;  // Deactivate magnet
+        world.magnetTimer = kNoTimer;
+        PushEvent(world, EventMagnetExpired, world.playerX, world.playerY);
+    }
+    else {
+        world.isInvincible = false;  // Deactivate invincibility
+        world.invincibilityTimer = kNoTimer;
+        PushEvent(world, EventInvincibilityExpired, world.playerX, world.playerY);
+    }
+}
+
+// Activate the power-up's effect for kPowerUpDurationTicks, on top of what is
+// left of it if it is active already
+static void CollectPowerUp(GameWorld& world, int archetype, int slot) {
+    EntityStore& store = world.entities;
+    float x = Column<ComponentX>(store, archetype)[slot];
+    float y = Column<ComponentY>(store, archetype)[slot];
+    int type = Column<ComponentVariant>(store, archetype)[slot];
+    TimerId& timer = type == 1 ? world.magnetTimer : world.invincibilityTimer;
+    if (!ExtendTimer(world.timers, timer, kPowerUpDurationTicks)) {
+        timer = ScheduleTimer(world.timers, kPowerUpDurationTicks, EndPowerUp, type);
+    }
+    if (type == 1) {
+        world.hasMagnet = true;  // Activate magnet
+        PushEvent(world, EventMagnetCollected, x, y);
+    }
+    else {
+        world.isInvincible = true;  // Activate invincibility
+        PushEvent(world, EventInvincibilityCollected, x, y);
+    }
+    Column<ComponentActive>(store, archetype)[slot] = false;  // Deactivate power-up after it's collected
+}
+
+// Power-up (TagPowerUp) touching the player
+static void TouchPowerUp(GameWorld& world, int archetype, int s) {
+    EntityStore& store = world.entities;
+    float y = Column<ComponentY>(store, archetype)[s];
+    // Check if the player is on the ground or within a certain jumping height
+    if (Column<ComponentLane>(store, archetype)[s] == LaneGround) {  // Assuming playerY = 0 is ground level
+        if (world.playerY <= 0.1f) {
+            // Collect the power-up if the player is on the ground and aligned with it
+            CollectPowerUp(world, archetype, s);
+        }
+    }
+    else {
+        // If the player is jumping, check if they are above the power-up and within range
+        if (world.playerY >= y + 0.5f) {
+            CollectPowerUp(world, archetype, s);
+        }
+        else {
+            PushEvent(world, EventPowerUpMissed, Column<ComponentX>(store, archetype)[s], y);
+        }
+    }
+}
+
+// Timer callback ending the knockback
+static void EndKnockback(void* context, int) {
+    GameWorld& world = *(GameWorld*)context;
+    world.isKnockedBack = false;
+    world.knockbackTimer = kNoTimer;
+    world.playerX = -0.8f;  // Reset the player to their original X position
+}
+
+// Knock the player back for knockbackDuration ticks and take a life
+static void HitPlayer(GameWorld& world, int archetype, int slot, GameEventType type) {
+    EntityStore& store = world.entities;
+    CancelTimer(world.timers, world.knockbackTimer);  // A new hit restarts the knockback
+    world.knockbackTimer = ScheduleTimer(world.timers, world.knockbackDuration, EndKnockback, 0);
+    world.isKnockedBack = true;
+    world.playerX -= world.knockbackStrength;
+    world.lives--;
+    PushEvent(world, type, Column<ComponentX>(store, archetype)[slot], Column<ComponentY>(store, archetype)[slot]);
+    Column<ComponentHasHit>(store, archetype)[slot] = true;
+    if (world.lives == 0) {
+        world.gameLose = true;  // Set game over flag
+        PushEvent(world, EventGameLose, world.playerX, world.playerY);
+    }
+}
+
+// Hazard (TagHazard) touching the player. A hazard hits the player at most
+// once: once it has scrolled past the column it never overlaps it again, so
+// its HasHit flag needs no reset.
+static void TouchHazard(GameWorld& world, int archetype, int s) {
+    EntityStore& store = world.entities;
+    if (Column<ComponentLane>(store, archetype)[s] == LaneGround && world.playerY <= 0.0f && !world.isInvincible) {
+        HitPlayer(world, archetype, s, EventHitGroundObstacle);
+    }
+    else if (!world.isDucking && world.playerY <= Column<ComponentHeight>(store, archetype)[s] && !world.isInvincible) {
+        HitPlayer(world, archetype, s, EventHitAboveObstacle);
+    }
+}
+
+// Contact system: the entities that overlap the player column, out of the
+// archetypes that can touch it (those with a width), go to the response of
+// their archetype's tag. Collected and spent entities are skipped. Only the
+// entities that OverlapRange finds near the column are visited; the spawn
+// width of each kind bounds how far left of the column an overlapping entity
+// can start.
+static void CheckContacts(GameWorld& world) {
+    EntityStore& store = world.entities;
+    for (int a = 0; a < store.archetypeCount; a++) {
+        const Archetype& archetype = store.archetypes[a];
+        if (!HasComponents(archetype, ComponentBit(ComponentWidth))) {
+            continue;
+        }
+        const float* x = Column<ComponentX>(store, a);
+        const float* width = Column<ComponentWidth>(store, a);
+        const bool* active = HasComponents(archetype, ComponentBit(ComponentActive)) ? Column<ComponentActive>(store, a) : NULL;
+        const bool* hasHit = HasComponents(archetype, ComponentBit(ComponentHasHit)) ? Column<ComponentHasHit>(store, a) : NULL;
+        int first, end;
+        OverlapRange(store, a, kPlayerColumnLeft, kPlayerColumnRight, kEntityKinds[a].width, first, end);
+        for (int i = first; i < end; i++) {
+            int s = EntitySlot(archetype, i);
+            if ((active != NULL && !active[s]) || (hasHit != NULL && hasHit[s]) || !OverlapsPlayerColumn(x[s], width[s])) {
+                continue;
+            }
+            if (HasComponents(archetype, ComponentBit(TagHazard))) {
+                TouchHazard(world, a, s);
+            }
+            else if (HasComponents(archetype, ComponentBit(TagScore))) {
+                TouchScore(world, a, s);
+            }
+            else if (HasComponents(archetype, ComponentBit(TagPowerUp))) {
+                TouchPowerUp(world, a, s);
+            }
+        }
+    }
+}
+
+// Knockback and readjustment logic
+static void UpdateKnockback(GameWorld& world) {
+    if (world.isKnockedBack) {
+        world.playerX -= world.knockbackStrength;  // Move player back until EndKnockback
+    }
+    if (world.isReadjusting) {
+        if (world.playerX < -0.8f) {
+            world.playerX += world.readjustSpeed;  // Move player back toward original position
+            if (world.playerX >= -0.8f) {
+                world.playerX = -0.8f;  // Snap back to original position
+                world.isReadjusting = false;  // Stop readjusting
+            }
+        }
+    }
+}
+
+void StepGameWorld(GameWorld& world, const TickInput& input) {
+    world.eventCount = 0;
+    if (world.gameEnd || world.gameLose) {
+        return;
+    }
+
+    // Update game time
+    int currentTime = (int)(world.tick / kTicksPerSecond);
+    world.gameTime = kGameDurationSeconds - currentTime;  // Countdown
+    if (world.gameTime <= 0) {
+        world.gameEnd = true;  // Set game end flag when time runs out
+        PushEvent(world, EventGameEnd, world.playerX, world.playerY);
+        return;
+    }
+
+    world.prevPlayerX = world.playerX;
+    world.prevPlayerY = world.playerY;
+
+    if (input.jumpPressed && !world.isJumping) {  // Space for jump
+        world.isJumping = true;
+    }
+    world.isDucking = input.duckHeld;  // Ducking is allowed in the air
+
+    AdvanceLevel(world);
+    UpdateKnockback(world);
+    JumpMechanics(world);
+    MoveEntities(world);  // Move every entity towards the player
+    CheckContacts(world);  // Hits, pickups and power-ups
+    world.gameSpeed = GameSpeedAfterTick(world.gameSpeed, world.tick);  // Increase game speed every 5 seconds
+    SpawnDue(world);  // Spawn the entities laid out for this tick
+
+    AdvanceTimerWheel(world.timers, &world);  // Fire the timed effects ending this tick
+    world.distance += world.gameSpeed;
+    world.tick++;
+}
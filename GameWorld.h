@@ -0,0 +1,210 @@
+#pragma once
+
+#include "EntityStore.h"
+#include "SpscQueue.h"
+#include "TimerWheel.h"
+
+// Simulation rate: one call to StepGameWorld advances the game by one tick
+const int kTicksPerSecond = 60;
+const int kGameDurationSeconds = 60;      // Length of a round
+const int kPowerUpDurationTicks = 5 * kTicksPerSecond;  // Magnet / invincibility last 5 seconds, more if picked up again
+const int kMaxEventsPerTick = 32;         // Events beyond this in a single tick are dropped
+const float kStartGameSpeed = 0.01f;      // Scroll distance per tick at the start of a round
+
+// Entity capacities. An entity lives for at most 2 / gameSpeed = 200 ticks, and
+// spawns are rare enough that these are never reached in practice; a spawn
+// into a full archetype is skipped.
+const int kMaxObstacles = 16;             // Obstacles are at least 0.5 apart, so at most 5 are on screen
+const int kMaxCollectibles = 64;
+const int kMaxPowerUps = 32;
+
+// Entity dimensions assigned at spawn time. The renderer builds its meshes from these.
+const float kObstacleWidth = 0.1f;
+const float kGroundObstacleHeight = 0.2f;  // Obstacle on the ground, jumped over
+const float kAboveObstacleHeight = 0.25f;  // Obstacle above the ground, ducked under
+const float kCollectibleSize = 0.05f;
+const float kPowerUpSize = 0.05f;
+
+// Collisions are tested against this fixed column, even while knockback moves
+// the drawn player away from it
+const float kPlayerColumnLeft = -0.8f;
+const float kPlayerColumnRight = kPlayerColumnLeft + 0.1f;
+
+// Row an entity was spawned in, decided once at spawn time so collision code
+// never compares y positions
+enum EntityLane {
+    LaneGround,  // Obstacles: on the ground, jumped over. Collectibles / power-ups: picked up while running
+    LaneRaised   // Obstacles: above the ground, ducked under. Collectibles / power-ups: high in the air, jumped for
+};
+
+// Kinds of entity. Each is one archetype of GameWorld::entities, with the
+// same index, and is described by its row of kEntityKinds.
+enum EntityKind {
+    KindObstacle,
+    KindCollectible,
+    KindPowerUp,
+    kEntityKindCount
+};
+
+struct EntityKindInfo {
+    ComponentMask components;
+    int capacity;
+    float width;               // ComponentWidth at spawn, which also bounds the collision broadphase
+    float y[2];                // ComponentY at spawn, by EntityLane
+    float height[2];           // ComponentHeight at spawn, by EntityLane
+};
+
+const EntityKindInfo kEntityKinds[kEntityKindCount] = {
+    // Obstacle: on the ground, sitting above the grass aligned with the player,
+    // or slightly above the player (ducked under)
+    { ComponentBit(ComponentY) | ComponentBit(ComponentLane) | ComponentBit(ComponentWidth) | ComponentBit(ComponentHeight) |
+          ComponentBit(ComponentHasHit) | ComponentBit(TagHazard),
+      kMaxObstacles, kObstacleWidth, { -0.7f, -0.5f }, { kGroundObstacleHeight, kAboveObstacleHeight } },
+    // Collectible: at ground level or high in the air
+    { ComponentBit(ComponentY) | ComponentBit(ComponentLane) | ComponentBit(ComponentWidth) | ComponentBit(ComponentActive) |
+          ComponentBit(TagScore),
+      kMaxCollectibles, kCollectibleSize, { -0.6f, 0.5f }, { 0.0f, 0.0f } },
+    // Power-up: like a collectible; its variant is the type (1 magnet, 2 invincibility)
+    { ComponentBit(ComponentY) | ComponentBit(ComponentLane) | ComponentBit(ComponentWidth) | ComponentBit(ComponentActive) |
+          ComponentBit(ComponentVariant) | ComponentBit(TagPowerUp),
+      kMaxPowerUps, kPowerUpSize, { -0.6f, 0.5f }, { 0.0f, 0.0f } },
+};
+
+// The level ahead of the player is laid out in chunks of consecutive ticks
+// by LevelGenerator.h, either inline when a tick runs out of spawns or on a
+// ChunkFeed thread ahead of time. Generation is sequential and only depends
+// on the round's seed, so both produce the same chunks.
+
+// One entity to spawn at the right edge of the screen
+struct LevelEntry {
+    int tick;                  // World tick in which it spawns
+    unsigned char kind;        // EntityKind
+    unsigned char lane;        // EntityLane
+    unsigned char variant;     // ComponentVariant: 1 magnet, 2 invincibility for power-ups
+};
+
+// Everything the generator carries from one chunk to the next
+struct LevelGenerator {
+    unsigned long long randomState;  // Private xorshift64* generator
+    long tick;                 // First tick not laid out yet
+    float gameSpeed;           // The world's speed at the start of that tick
+    float lastObstacleX;       // Where the newest obstacle is at the start of that tick
+    bool hasObstacle;
+};
+
+const int kLevelChunkTicks = 2 * kTicksPerSecond;  // Ticks per chunk, unless it fills up first
+const int kMaxLevelEntries = 32;
+
+struct LevelChunk {
+    long firstTick;
+    long endTick;              // One past the last tick the chunk covers
+    int entryCount;
+    LevelEntry entries[kMaxLevelEntries];  // Ordered by tick
+    LevelGenerator next;       // State that lays out the following chunk
+};
+
+const int kChunkFeedCapacity = 4;  // Chunks a feed may generate ahead: 8 seconds of play
+typedef SpscQueue<LevelChunk, kChunkFeedCapacity> LevelChunkQueue;
+
+// Things that happened during a tick, for the front end to print, play or draw
+enum GameEventType {
+    EventCollectedWithMagnet,
+    EventCollectedGround,
+    EventCollectedHigh,
+    EventMagnetCollected,
+    EventInvincibilityCollected,
+    EventPowerUpMissed,        // High power-up overlapped the player but was not reached
+    EventHitGroundObstacle,
+    EventHitAboveObstacle,
+    EventMagnetExpired,
+    EventInvincibilityExpired,
+    EventGameEnd,              // Countdown reached zero
+    EventGameLose              // Player lost the last life
+};
+
+struct GameEvent {
+    GameEventType type;
+    float x, y;        // Position of the entity involved (0,0 if none)
+};
+
+// Player input sampled once per tick
+struct TickInput {
+    bool jumpPressed;  // Space was pressed since the previous tick
+    bool duckHeld;     // 'd' is held down
+};
+
+// Complete simulation state. Contains no GL or GLUT state so it can be
+// stepped without a window (see HeadlessMain.cpp). A round is determined
+// entirely by its seed and the input of every tick, on every platform, which
+// is what makes replays (Replay.h) possible.
+struct GameWorld {
+    long tick;                 // Ticks simulated since the round started
+    unsigned int seed;         // Seed the round was started with
+    float playerX;             // Player's X position (moves during knockback)
+    float playerY;             // Player's Y position (for jumping)
+    float prevPlayerX;         // Player position before the last tick
+    float prevPlayerY;
+    bool isJumping;            // Whether the player is in the air
+    bool isDucking;            // Whether the player is ducking
+    float jumpVelocity;        // Velocity for jumping
+    float gravity;             // Gravity effect
+    float gameSpeed;           // Speed of the game (increases over time)
+    float distance;            // How far the world has scrolled this round
+    int lives;                 // Player lives
+    int score;                 // Player score
+    int gameTime;              // Seconds left on the countdown
+    bool hasMagnet;            // Track if player has the magnet power-up
+    bool isInvincible;         // Track if player is invincible
+    TimerId magnetTimer;       // Ends the magnet; kNoTimer while it is off
+    TimerId invincibilityTimer;
+    bool isKnockedBack;        // Player is being pushed back
+    bool isReadjusting;
+    float readjustSpeed;       // Speed to move the player back to the original position
+    float knockbackStrength;   // How much the player is knocked back
+    int knockbackDuration;     // How many ticks the knockback lasts
+    TimerId knockbackTimer;    // Ends the knockback; kNoTimer while there is none
+    bool gameEnd;              // Flag for when the timer runs out
+    bool gameLose;             // Flag for when player loses all health
+
+    // Spawns of the current chunk; nextEntry is the first one not spawned yet
+    LevelChunk level;
+    int nextEntry;
+    // Source of the following chunks: a ChunkFeed's queue, or NULL to lay them
+    // out inline. A copy of the world must set it to NULL, so the copy does
+    // not take chunks meant for the original.
+    LevelChunkQueue* chunkFeed;
+
+    // One archetype per EntityKind. Entities of each are ordered by spawn
+    // time, which is also left-to-right screen order.
+    EntityStore entities;
+
+    GameEvent events[kMaxEventsPerTick];  // Events raised by the last StepGameWorld call
+    int eventCount;
+
+    // Timed effects, advanced in step with tick. Callbacks get the world.
+    TimerWheel timers;
+};
+
+// Reset the world to the start of a round played with the given random seed.
+// Detaches any ChunkFeed; stop it first.
+void InitGameWorld(GameWorld& world, unsigned int seed);
+
+// Lay out one archetype per EntityKind, in order, in an empty store
+void AddEntityArchetypes(EntityStore& store);
+
+// Spawn the entry's entity at the right edge of the screen. Returns its slot,
+// or -1 (spawning nothing) if its archetype is full.
+int SpawnEntity(EntityStore& store, const LevelEntry& entry);
+
+// Speed of the world after the tick, which runs at speed: it picks up every
+// fifth second
+inline float GameSpeedAfterTick(float speed, long tick) {
+    int currentTime = (int)(tick / kTicksPerSecond);
+    if (currentTime % 5 == 0 && currentTime != 0) {  // Ensure it doesn't run on the first second
+        speed += 0.0001f;  // Adjust this value for a steady increase
+    }
+    return speed;
+}
+
+// Advance the simulation by one tick. Does nothing once the round is over.
+void StepGameWorld(GameWorld& world, const TickInput& input);
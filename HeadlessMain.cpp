@@ -0,0 +1,97 @@
+// Headless simulation driver: steps the GameWorld without a window as fast as
+// possible and reports the simulation cost. Either plays rounds back to back,
+// without input or with a bot (see InputPolicy.h) for soak runs, or plays a
+// recorded replay (see Replay.h) a number of times and checks that it ends as
+// recorded.
+//
+// Usage: QuickRunnerHeadless [--policy NAME] [ticks] [seed]
+//        QuickRunnerHeadless --replay FILE [repeats]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "GameWorld.h"
+#include "InputPolicy.h"
+#include "Replay.h"
+
+static void PrintTiming(long ticks, double seconds) {
+    printf("elapsed: %.3f s\n", seconds);
+    printf("ticks/sec: %.0f\n", ticks / seconds);
+    printf("ns/tick: %.1f\n", seconds * 1e9 / ticks);
+}
+
+static int RunReplay(const char* path, long repeats) {
+    static Replay replay;
+    if (!LoadReplay(replay, path)) {
+        printf("Cannot read replay %s\n", path);
+        return 1;
+    }
+    static GameWorld world;
+    bool matches = true;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < repeats; i++) {
+        matches = PlayReplay(replay, world) && matches;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    printf("seed: %u\n", replay.seed);
+    printf("ticks: %ld x %ld\n", (long)replay.inputs.size(), repeats);
+    printf("score: %d (recorded %d)\n", world.score, replay.finalScore);
+    printf("lives: %d (recorded %d)\n", world.lives, replay.finalLives);
+    printf("world tick: %ld (recorded %ld)\n", world.tick, replay.finalTick);
+    PrintTiming((long)replay.inputs.size() * repeats, std::chrono::duration<double>(end - start).count());
+    if (!matches) {
+        printf("replay diverged\n");
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 2 && strcmp(argv[1], "--replay") == 0) {
+        long repeats = argc > 3 ? atol(argv[3]) : 1;
+        return RunReplay(argv[2], repeats > 0 ? repeats : 1);
+    }
+
+    PolicyKind policyKind = PolicyIdle;  // The player never jumps or ducks
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "--policy") == 0) {
+        if (!ParsePolicyKind(argv[2], policyKind)) {
+            printf("Unknown policy %s\n", argv[2]);
+            return 1;
+        }
+        first = 3;
+    }
+    long ticks = argc > first ? atol(argv[first]) : 1000000;  // Number of ticks to simulate
+    unsigned seed = argc > first + 1 ? (unsigned)atol(argv[first + 1]) : 1u;  // Seed of the first round
+    if (ticks <= 0) {
+        printf("Usage: %s [--policy NAME] [ticks] [seed]\n", argv[0]);
+        printf("       %s --replay FILE [repeats]\n", argv[0]);
+        return 1;
+    }
+
+    static GameWorld world;
+    InitGameWorld(world, seed);
+    InputPolicy policy;
+    InitInputPolicy(policy, policyKind, seed, 0.1f);
+    long rounds = 1;
+    long long totalScore = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < ticks; i++) {
+        StepGameWorld(world, NextPolicyInput(policy, world));
+        if (world.gameEnd || world.gameLose) {
+            totalScore += world.score;
+            InitGameWorld(world, seed + (unsigned)rounds);  // Keep the benchmark busy with a fresh round
+            rounds++;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    totalScore += world.score;
+
+    printf("ticks: %ld\n", ticks);
+    printf("rounds: %ld\n", rounds);
+    printf("total score: %lld\n", totalScore);  // Keeps the work observable
+    PrintTiming(ticks, std::chrono::duration<double>(end - start).count());
+    return 0;
+}
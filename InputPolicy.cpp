@@ -0,0 +1,157 @@
+#include "InputPolicy.h"
+
+#include <cstring>
+
+// Uniform in [0, 1) from the policy's own xorshift64*
+static float RandomUnit(InputPolicy& policy) {
+    unsigned long long x = policy.randomState;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    policy.randomState = x;
+    return (float)((x * 0x2545F4914F6CDD1DULL) >> 40) / (float)(1 << 24);
+}
+
+void InitInputPolicy(InputPolicy& policy, PolicyKind kind, unsigned long long seed, float missChance) {
+    policy.kind = kind;
+    policy.randomState = seed | 1;  // Never zero, which xorshift could not leave
+    policy.missChance = missChance;
+    policy.targetX = -2.0f;  // Left of anything on screen, so the first obstacle is a new target
+    policy.ignoringTarget = false;
+    policy.lead = 0.0f;
+}
+
+static TickInput ReactiveInput(InputPolicy& policy, const GameWorld& world) {
+    TickInput input = {};
+    // The nearest hazard not yet behind the player: the first one of each
+    // hazard archetype, since they are sorted by x
+    const EntityStore& store = world.entities;
+    const ComponentMask needed = ComponentBit(TagHazard) | ComponentBit(ComponentWidth) | ComponentBit(ComponentLane);
+    float targetX = 0.0f;
+    int targetLane = -1;
+    for (int a = 0; a < store.archetypeCount; a++) {
+        const Archetype& archetype = store.archetypes[a];
+        if (!HasComponents(archetype, needed)) {
+            continue;
+        }
+        const float* x = Column<ComponentX>(store, a);
+        const float* width = Column<ComponentWidth>(store, a);
+        for (int i = 0; i < archetype.count; i++) {
+            int s = EntitySlot(archetype, i);
+            if (x[s] + width[s] <= kPlayerColumnLeft) {
+                continue;  // Already behind the player
+            }
+            if (targetLane < 0 || x[s] < targetX) {
+                targetX = x[s];
+                targetLane = Column<ComponentLane>(store, a)[s];
+            }
+            break;
+        }
+    }
+    if (targetLane < 0) {
+        return input;
+    }
+
+    // Hazards only move left, so one further right than the target is the next one
+    if (targetX > policy.targetX) {
+        policy.ignoringTarget = RandomUnit(policy) < policy.missChance;
+        policy.lead = 0.1f + 0.2f * RandomUnit(policy);  // Reaction varies from obstacle to obstacle
+    }
+    policy.targetX = targetX;
+    if (!policy.ignoringTarget && targetX - kPlayerColumnRight < policy.lead) {
+        if (targetLane == LaneGround) {
+            input.jumpPressed = true;  // A jump clears about 1.0 of distance at any speed
+        }
+        else {
+            input.duckHeld = true;  // Until it has passed
+        }
+    }
+    return input;
+}
+
+// Value of playing one plan for kLookaheadTicks on a copy of world: a life
+// outweighs any score, a power-up is worth half a pickup
+static int EvaluatePlan(const GameWorld& world, bool jump, bool duck) {
+    GameWorld future = world;
+    future.chunkFeed = NULL;  // Lays out the level inline instead of taking the feed's chunks
+    int powerUps = 0;
+    for (int tick = 0; tick < kLookaheadTicks && !future.gameEnd && !future.gameLose; tick++) {
+        TickInput input = {};
+        input.jumpPressed = jump && tick == 0;
+        input.duckHeld = duck;
+        StepGameWorld(future, input);
+        for (int i = 0; i < future.eventCount; i++) {
+            if (future.events[i].type == EventMagnetCollected || future.events[i].type == EventInvincibilityCollected) {
+                powerUps++;
+            }
+        }
+    }
+    return (future.lives - world.lives) * 1000000 + (future.score - world.score) + powerUps * 250;
+}
+
+// Whether anything can reach the player column within kLookaheadTicks. If
+// nothing can, every plan ends the same and there is nothing to plan.
+static bool AnythingInReach(const GameWorld& world) {
+    float reach = kPlayerColumnRight + (world.gameSpeed + 0.001f) * kLookaheadTicks;  // Allows for a speed-up on the way
+    for (int a = 0; a < world.entities.archetypeCount; a++) {
+        int first, end;
+        OverlapRange(world.entities, a, kPlayerColumnLeft, reach, kEntityKinds[a].width, first, end);
+        if (first < end) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TickInput PlanLookaheadInput(const GameWorld& world) {
+    TickInput input = {};
+    if (!AnythingInReach(world)) {
+        return input;  // Keep running
+    }
+    int best = EvaluatePlan(world, false, false);
+    int duck = EvaluatePlan(world, false, true);
+    if (duck > best) {
+        best = duck;
+        input.duckHeld = true;
+    }
+    if (!world.isJumping && EvaluatePlan(world, true, false) > best) {  // In the air a jump changes nothing
+        input.jumpPressed = true;
+        input.duckHeld = false;
+    }
+    return input;
+}
+
+TickInput NextPolicyInput(InputPolicy& policy, const GameWorld& world) {
+    TickInput input = {};
+    switch (policy.kind) {
+    case PolicyScripted:
+        input.jumpPressed = world.tick % 37 == 0;
+        input.duckHeld = world.tick % 90 < 30;
+        break;
+    case PolicyReactive:
+        input = ReactiveInput(policy, world);
+        break;
+    case PolicyLookahead:
+        input = PlanLookaheadInput(world);
+        break;
+    default:
+        break;
+    }
+    return input;
+}
+
+static const char* const kPolicyNames[PolicyCount] = { "idle", "scripted", "reactive", "lookahead" };
+
+const char* PolicyName(PolicyKind kind) {
+    return kPolicyNames[kind];
+}
+
+bool ParsePolicyKind(const char* name, PolicyKind& kind) {
+    for (int i = 0; i < PolicyCount; i++) {
+        if (strcmp(name, kPolicyNames[i]) == 0) {
+            kind = (PolicyKind)i;
+            return true;
+        }
+    }
+    return false;
+}
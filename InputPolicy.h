@@ -0,0 +1,47 @@
+#pragma once
+
+#include "GameWorld.h"
+
+// Input for rounds played without a keyboard. Batch runs (BatchMain.cpp)
+// play a large number of rounds with one of these policies and look at how
+// they end. A policy draws from its own random stream, so a round played by a
+// policy is still determined entirely by the two seeds.
+
+enum PolicyKind {
+    PolicyIdle,      // Never jumps or ducks
+    PolicyScripted,  // Jumps and ducks on a fixed rhythm, blind to the level
+    PolicyReactive,  // Jumps over or ducks under the next obstacle once it is close, and sometimes misses one
+    PolicyLookahead, // Plays every choice a short time ahead on a copy of the world and takes the best
+    PolicyCount
+};
+
+struct InputPolicy {
+    PolicyKind kind;
+    unsigned long long randomState;  // Private xorshift64* stream
+    float missChance;          // Reactive: chance to ignore an obstacle altogether
+    // Reactive: the obstacle being reacted to, recognized by its position
+    float targetX;
+    bool ignoringTarget;
+    float lead;                // Distance to the player column at which it reacts to the target
+};
+
+void InitInputPolicy(InputPolicy& policy, PolicyKind kind, unsigned long long seed, float missChance);
+
+// Lookahead: ticks each choice is played ahead. Obstacles move 0.3 in that
+// time at the starting speed, enough to see every hit coming while a jump or
+// duck started now can still avoid it.
+const int kLookaheadTicks = 30;
+
+// Input for the next StepGameWorld call on world
+TickInput NextPolicyInput(InputPolicy& policy, const GameWorld& world);
+
+// Lookahead: the input the planner picks for world. Plays running on, ducking
+// and jumping now for kLookaheadTicks each, with StepGameWorld on a copy.
+// Lives count before score; among equal plans the one that does the least
+// wins. A few microseconds per call.
+TickInput PlanLookaheadInput(const GameWorld& world);
+
+const char* PolicyName(PolicyKind kind);
+
+// False if name is not one of the PolicyName names
+bool ParsePolicyKind(const char* name, PolicyKind& kind);
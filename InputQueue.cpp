@@ -0,0 +1,69 @@
+#include "InputQueue.h"
+
+void InitInputQueue(InputQueue& queue) {
+    InputEvent discarded;
+    while (queue.events.pop(discarded)) {
+    }
+    queue.nextSequence = 1;
+    queue.droppedEvents = 0;
+    queue.duckDown = false;
+    queue.newest.sequence = 0;
+}
+
+void PushInput(InputQueue& queue, InputAction action) {
+    InputEvent event;
+    event.action = action;
+    event.sequence = queue.nextSequence++;
+    event.time = std::chrono::steady_clock::now();
+    if (!queue.events.push(event)) {
+        queue.droppedEvents++;
+    }
+}
+
+TickInput DrainInput(InputQueue& queue) {
+    TickInput input = {};
+    bool duckPressed = false;
+    InputEvent event;
+    while (queue.events.pop(event)) {
+        switch (event.action) {
+        case InputJump:
+            input.jumpPressed = true;
+            break;
+        case InputDuckDown:
+            queue.duckDown = true;
+            duckPressed = true;
+            break;
+        case InputDuckUp:
+            queue.duckDown = false;
+            break;
+        }
+        queue.newest.sequence = event.sequence;
+        queue.newest.time = event.time;
+    }
+    input.duckHeld = queue.duckDown || duckPressed;  // A tap within the tick still ducks for it
+    return input;
+}
+
+void InitInputLatency(InputLatency& latency) {
+    latency.sampleCount = 0;
+    latency.presented = 0;
+}
+
+void RecordPresentedInput(InputLatency& latency, const InputStamp& frameInput) {
+    if (frameInput.sequence == latency.presented) {
+        return;  // Nothing new in this frame
+    }
+    latency.presented = frameInput.sequence;
+    float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameInput.time).count();
+    latency.samplesMs[latency.sampleCount++ & (kLatencySamples - 1)] = ms;
+}
+
+int ComputeInputLatencyStats(const InputLatency& latency, ProfileStats& stats) {
+    int count = latency.sampleCount < (unsigned int)kLatencySamples ? (int)latency.sampleCount : kLatencySamples;
+    float samples[kLatencySamples];
+    for (int i = 0; i < count; i++) {
+        samples[i] = latency.samplesMs[i];
+    }
+    stats = ComputePercentiles(samples, count);
+    return count;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include "GameWorld.h"
+#include "Profiler.h"
+#include "SpscQueue.h"
+
+// Keyboard input on its way from the GLUT callbacks to the simulation. The
+// callbacks push timestamped events; each tick drains everything queued so
+// far, in order, into its TickInput. Nothing is overwritten between ticks, so
+// a 'd' tap shorter than a tick still ducks for one tick.
+//
+// Every event carries a sequence number. The simulation remembers the newest
+// event it has consumed, each frame is tagged with that stamp when it is
+// drawn, and once the frame is presented the time since the key went down is
+// one input-to-present latency sample.
+
+enum InputAction {
+    InputJump,
+    InputDuckDown,
+    InputDuckUp
+};
+
+typedef std::chrono::steady_clock::time_point InputTime;
+
+struct InputEvent {
+    InputAction action;
+    unsigned int sequence;  // 1, 2, 3... in the order the keys were pressed
+    InputTime time;         // When the callback saw the key
+};
+
+// The newest event reflected by a tick or frame; sequence 0 means none yet
+struct InputStamp {
+    unsigned int sequence;
+    InputTime time;
+};
+
+const int kInputQueueCapacity = 64;  // Far more keys than anyone presses in one tick
+
+struct InputQueue {
+    SpscQueue<InputEvent, kInputQueueCapacity> events;
+    unsigned int nextSequence;  // Producer side
+    long droppedEvents;         // Producer side: pushes that found the queue full
+    bool duckDown;              // Consumer side: 'd' state after the events drained so far
+    InputStamp newest;          // Consumer side: newest event drained
+};
+
+// Empties the queue too. Only while no thread is pushing.
+void InitInputQueue(InputQueue& queue);
+
+// Producer: record a key event now
+void PushInput(InputQueue& queue, InputAction action);
+
+// Consumer: drain every queued event into the input for one tick
+TickInput DrainInput(InputQueue& queue);
+
+const int kLatencySamples = 256;  // Latencies kept for statistics (power of two)
+
+struct InputLatency {
+    float samplesMs[kLatencySamples];
+    unsigned int sampleCount;  // Samples recorded so far; the ring keeps the newest
+    unsigned int presented;    // Sequence of the newest input already measured
+};
+
+void InitInputLatency(InputLatency& latency);
+
+// Call right after presenting a frame, with the stamp it was drawn with. Each
+// input is measured once, by the first frame that shows it.
+void RecordPresentedInput(InputLatency& latency, const InputStamp& frameInput);
+
+// Percentiles in milliseconds over the samples in the ring. Returns how many
+// samples they cover.
+int ComputeInputLatencyStats(const InputLatency& latency, ProfileStats& stats);
@@ -0,0 +1,230 @@
+#include "InstanceRenderer.h"
+
+#include <cstddef>
+#include "GLExtensions.h"
+#include "Logger.h"
+
+const size_t kReservedInstances = 256;  // Per mesh; lists only grow past this
+
+// Attribute slots, bound before linking
+const GLuint kPositionAttribute = 0;
+const GLuint kColorAttribute = 1;
+const GLuint kInstanceAttribute = 2;
+
+// Places the mesh vertex like BatchTranslate / BatchScale / BatchRotate would
+static const char* kVertexShader =
+    "#version 110\n"
+    "attribute vec2 position;\n"
+    "attribute vec4 color;\n"
+    "attribute vec4 instance;  // x, y, scale, rotation in degrees\n"
+    "varying vec4 vertexColor;\n"
+    "void main() {\n"
+    "    float angle = radians(instance.w);\n"
+    "    float c = cos(angle);\n"
+    "    float s = sin(angle);\n"
+    "    vec2 p = position * instance.z;\n"
+    "    p = vec2(c * p.x - s * p.y, s * p.x + c * p.y) + instance.xy;\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix * vec4(p, 0.0, 1.0);\n"
+    "    vertexColor = color;\n"
+    "}\n";
+
+static const char* kFragmentShader =
+    "#version 110\n"
+    "varying vec4 vertexColor;\n"
+    "void main() {\n"
+    "    gl_FragColor = vertexColor;\n"
+    "}\n";
+
+static GLuint CompileShader(GLenum type, const char* source) {
+    GLuint shader = glExt.CreateShader(type);
+    glExt.ShaderSource(shader, 1, &source, NULL);
+    glExt.CompileShader(shader);
+
+    GLint compiled = 0;
+    glExt.GetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+        char log[1024];
+        glExt.GetShaderInfoLog(shader, sizeof(log), NULL, log);
+        LOG_ERROR("Instance shader failed to compile: %s", log);
+        glExt.DeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+// Returns 0 if the program cannot be built
+static GLuint BuildProgram() {
+    GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, kVertexShader);
+    GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, kFragmentShader);
+    if (vertexShader == 0 || fragmentShader == 0) {
+        return 0;
+    }
+
+    GLuint program = glExt.CreateProgram();
+    glExt.AttachShader(program, vertexShader);
+    glExt.AttachShader(program, fragmentShader);
+    glExt.BindAttribLocation(program, kPositionAttribute, "position");
+    glExt.BindAttribLocation(program, kColorAttribute, "color");
+    glExt.BindAttribLocation(program, kInstanceAttribute, "instance");
+    glExt.LinkProgram(program);
+    glExt.DeleteShader(vertexShader);  // Freed together with the program
+    glExt.DeleteShader(fragmentShader);
+
+    GLint linked = 0;
+    glExt.GetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        char log[1024];
+        glExt.GetProgramInfoLog(program, sizeof(log), NULL, log);
+        LOG_ERROR("Instance shader failed to link: %s", log);
+        return 0;
+    }
+    return program;
+}
+
+void InitInstanceRenderer(InstanceRenderer& renderer) {
+    renderer.meshVertices.clear();
+    renderer.meshCount = 0;
+    for (int i = 0; i < kMaxInstanceMeshes; i++) {
+        renderer.instances[i].clear();
+        renderer.instances[i].reserve(kReservedInstances);
+    }
+    renderer.meshesUploaded = false;
+    renderer.program = 0;
+    renderer.meshBuffer = 0;
+    renderer.instanceBuffer = 0;
+    renderer.drawCalls = 0;
+
+    renderer.useInstancing = glExt.hasInstancing && glExt.hasVertexBuffers;
+    if (renderer.useInstancing) {
+        renderer.program = BuildProgram();
+        renderer.useInstancing = renderer.program != 0;
+    }
+    if (renderer.useInstancing) {
+        glExt.GenBuffers(1, &renderer.meshBuffer);
+        glExt.GenBuffers(1, &renderer.instanceBuffer);
+    }
+}
+
+int AddInstanceMesh(InstanceRenderer& renderer, const RenderBatch& source) {
+    if (renderer.meshCount == kMaxInstanceMeshes) {
+        return -1;
+    }
+
+    InstanceMesh& mesh = renderer.meshes[renderer.meshCount];
+    std::vector<BatchVertex>& vertices = renderer.meshVertices;
+    mesh.firstTriangle = (int)vertices.size();
+    mesh.triangleCount = (int)source.triangles.size();
+    vertices.insert(vertices.end(), source.triangles.begin(), source.triangles.end());
+    mesh.firstLine = (int)vertices.size();
+    mesh.lineCount = (int)source.lines.size();
+    vertices.insert(vertices.end(), source.lines.begin(), source.lines.end());
+
+    renderer.meshesUploaded = false;
+    return renderer.meshCount++;
+}
+
+void InstanceReset(InstanceRenderer& renderer) {
+    for (int i = 0; i < renderer.meshCount; i++) {
+        renderer.instances[i].clear();
+    }
+}
+
+void AddInstance(InstanceRenderer& renderer, int mesh, float x, float y, float scale, float rotation) {
+    if (mesh < 0 || mesh >= renderer.meshCount) {
+        return;
+    }
+    EntityInstance instance;
+    instance.x = x;
+    instance.y = y;
+    instance.scale = scale;
+    instance.rotation = rotation;
+    renderer.instances[mesh].push_back(instance);
+}
+
+// Expand every instance on the CPU and draw them through the batch
+static void FlushFallback(InstanceRenderer& renderer, RenderBatch& batch) {
+    BatchReset(batch);
+    for (int i = 0; i < renderer.meshCount; i++) {
+        const InstanceMesh& mesh = renderer.meshes[i];
+        const BatchVertex* vertices = renderer.meshVertices.data();
+        for (const EntityInstance& instance : renderer.instances[i]) {
+            BatchPushMatrix(batch);
+            BatchTranslate(batch, instance.x, instance.y);
+            BatchScale(batch, instance.scale, instance.scale);
+            BatchRotate(batch, instance.rotation);
+            BatchMesh(batch, vertices + mesh.firstTriangle, mesh.triangleCount, vertices + mesh.firstLine, mesh.lineCount);
+            BatchPopMatrix(batch);
+        }
+    }
+    BatchFlush(batch);
+    renderer.drawCalls = batch.drawCalls;
+}
+
+void InstanceFlush(InstanceRenderer& renderer, RenderBatch& fallback) {
+    renderer.drawCalls = 0;
+    if (!renderer.useInstancing) {
+        FlushFallback(renderer, fallback);
+        return;
+    }
+
+    size_t instanceCount = 0;
+    for (int i = 0; i < renderer.meshCount; i++) {
+        instanceCount += renderer.instances[i].size();
+    }
+    if (instanceCount == 0) {
+        return;
+    }
+
+    size_t vertexStride = sizeof(BatchVertex);
+    size_t instanceStride = sizeof(EntityInstance);
+    glExt.BindBuffer(GL_ARRAY_BUFFER, renderer.meshBuffer);
+    if (!renderer.meshesUploaded) {
+        glExt.BufferData(GL_ARRAY_BUFFER, (ptrdiff_t)(renderer.meshVertices.size() * vertexStride), renderer.meshVertices.data(), GL_STATIC_DRAW);
+        renderer.meshesUploaded = true;
+    }
+    glExt.VertexAttribPointer(kPositionAttribute, 2, GL_FLOAT, GL_FALSE, (GLsizei)vertexStride, (const void*)offsetof(BatchVertex, x));
+    glExt.VertexAttribPointer(kColorAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, (GLsizei)vertexStride, (const void*)offsetof(BatchVertex, r));
+    glExt.EnableVertexAttribArray(kPositionAttribute);
+    glExt.EnableVertexAttribArray(kColorAttribute);
+
+    // Orphan last frame's instances and stream this frame's, mesh after mesh
+    glExt.BindBuffer(GL_ARRAY_BUFFER, renderer.instanceBuffer);
+    glExt.BufferData(GL_ARRAY_BUFFER, (ptrdiff_t)(instanceCount * instanceStride), NULL, GL_STREAM_DRAW);
+    size_t offset = 0;
+    for (int i = 0; i < renderer.meshCount; i++) {
+        size_t count = renderer.instances[i].size();
+        glExt.BufferSubData(GL_ARRAY_BUFFER, (ptrdiff_t)(offset * instanceStride), (ptrdiff_t)(count * instanceStride), renderer.instances[i].data());
+        offset += count;
+    }
+    glExt.EnableVertexAttribArray(kInstanceAttribute);
+    glExt.VertexAttribDivisor(kInstanceAttribute, 1);
+
+    glExt.UseProgram(renderer.program);
+    offset = 0;
+    for (int i = 0; i < renderer.meshCount; i++) {
+        const InstanceMesh& mesh = renderer.meshes[i];
+        GLsizei count = (GLsizei)renderer.instances[i].size();
+        if (count == 0) {
+            continue;
+        }
+
+        // No base instance before GL 4.2, so point the attribute at this mesh's range instead
+        glExt.VertexAttribPointer(kInstanceAttribute, 4, GL_FLOAT, GL_FALSE, (GLsizei)instanceStride, (const void*)(offset * instanceStride));
+        if (mesh.triangleCount > 0) {
+            glExt.DrawArraysInstanced(GL_TRIANGLES, mesh.firstTriangle, mesh.triangleCount, count);
+            renderer.drawCalls++;
+        }
+        if (mesh.lineCount > 0) {
+            glExt.DrawArraysInstanced(GL_LINES, mesh.firstLine, mesh.lineCount, count);
+            renderer.drawCalls++;
+        }
+        offset += count;
+    }
+
+    glExt.UseProgram(0);
+    glExt.VertexAttribDivisor(kInstanceAttribute, 0);
+    glExt.DisableVertexAttribArray(kInstanceAttribute);
+    glExt.DisableVertexAttribArray(kColorAttribute);
+    glExt.DisableVertexAttribArray(kPositionAttribute);
+    glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include "RenderBatch.h"
+
+const int kMaxInstanceMeshes = 8;
+
+// Where to place one copy of a mesh. This is the whole per-instance record
+// streamed to the GPU each frame; which mesh it belongs to (the entity type)
+// is given by the list it is stored in.
+struct EntityInstance {
+    float x, y;        // Position of the mesh origin
+    float scale;       // Uniform scale
+    float rotation;    // Degrees, counter-clockwise like glRotatef
+};
+
+struct InstanceMesh {
+    int firstTriangle, triangleCount;  // Vertex ranges in InstanceRenderer::meshVertices
+    int firstLine, lineCount;
+};
+
+// Draws many copies of a few small meshes. Meshes are recorded once with the
+// RenderBatch API and kept in a static vertex buffer; each frame only the
+// instance records are uploaded, and every mesh is drawn with one instanced
+// call per primitive type, however many entities use it. Without shader and
+// instancing support the instances are expanded on the CPU into a RenderBatch.
+struct InstanceRenderer {
+    std::vector<BatchVertex> meshVertices;          // Triangles, then lines, of every mesh
+    InstanceMesh meshes[kMaxInstanceMeshes];
+    int meshCount;
+    std::vector<EntityInstance> instances[kMaxInstanceMeshes];  // This frame's instances, per mesh
+
+    bool useInstancing;                             // False: CPU fallback through a RenderBatch
+    bool meshesUploaded;
+    GLuint program;
+    GLuint meshBuffer;
+    GLuint instanceBuffer;                          // Streamed once per frame
+    int drawCalls;                                  // Draw calls issued by the last InstanceFlush
+};
+
+// Compile the shader and create the buffers. Requires a current GL context
+// and LoadGLExtensions.
+void InitInstanceRenderer(InstanceRenderer& renderer);
+
+// Copy the triangles and lines recorded in source into a new mesh. Returns
+// the mesh id, or -1 when kMaxInstanceMeshes meshes exist already.
+int AddInstanceMesh(InstanceRenderer& renderer, const RenderBatch& source);
+
+// Start a new frame: drop last frame's instances
+void InstanceReset(InstanceRenderer& renderer);
+
+void AddInstance(InstanceRenderer& renderer, int mesh, float x, float y, float scale, float rotation);
+
+// Draw every instance. The fallback batch is reset and reused when instancing
+// is unavailable, so flush it before calling this.
+void InstanceFlush(InstanceRenderer& renderer, RenderBatch& fallback);
@@ -0,0 +1,136 @@
+#include "LayerCache.h"
+
+#include <cmath>
+#include "GLExtensions.h"
+
+static bool framebuffersWork = true;  // Cleared if the driver rejects a layer's framebuffer
+
+bool LayerCacheAvailable() {
+    return glExt.hasFramebuffers && framebuffersWork;
+}
+
+void InitCachedLayer(CachedLayer& layer, float left, float bottom, float right, float top) {
+    layer.left = left;
+    layer.bottom = bottom;
+    layer.right = right;
+    layer.top = top;
+    layer.framebuffer = 0;
+    layer.texture = 0;
+    layer.viewportWidth = 0;
+    layer.viewportHeight = 0;
+    layer.x = layer.y = layer.width = layer.height = 0;
+    layer.key = 0;
+    layer.valid = false;
+    layer.renders = 0;
+}
+
+// First pixel at or before coordinate (-1..1) across size pixels, and the
+// pixel after the last one at or after it
+static int PixelBelow(float coordinate, int size) {
+    int pixel = (int)floorf((coordinate + 1.0f) * 0.5f * size);
+    return pixel < 0 ? 0 : (pixel > size ? size : pixel);
+}
+
+static int PixelAbove(float coordinate, int size) {
+    int pixel = (int)ceilf((coordinate + 1.0f) * 0.5f * size);
+    return pixel < 0 ? 0 : (pixel > size ? size : pixel);
+}
+
+// (Re)allocate the texture for a new viewport size and attach it
+static bool ResizeLayer(CachedLayer& layer, int viewportWidth, int viewportHeight) {
+    layer.x = PixelBelow(layer.left, viewportWidth);
+    layer.y = PixelBelow(layer.bottom, viewportHeight);
+    layer.width = PixelAbove(layer.right, viewportWidth) - layer.x;
+    layer.height = PixelAbove(layer.top, viewportHeight) - layer.y;
+    layer.viewportWidth = viewportWidth;
+    layer.viewportHeight = viewportHeight;
+    if (layer.width <= 0 || layer.height <= 0) {
+        return false;  // Window too small to cover anything
+    }
+
+    if (layer.framebuffer == 0) {
+        glExt.GenFramebuffers(1, &layer.framebuffer);
+        glGenTextures(1, &layer.texture);
+    }
+    glBindTexture(GL_TEXTURE_2D, layer.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);  // Blitted texel for pixel
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, layer.width, layer.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glExt.BindFramebuffer(GL_FRAMEBUFFER, layer.framebuffer);
+    glExt.FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, layer.texture, 0);
+    if (glExt.CheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        glExt.BindFramebuffer(GL_FRAMEBUFFER, 0);
+        framebuffersWork = false;
+        return false;
+    }
+    return true;
+}
+
+bool BeginLayerRender(CachedLayer& layer, unsigned long long key) {
+    if (!LayerCacheAvailable()) {
+        return false;
+    }
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    bool resized = viewport[2] != layer.viewportWidth || viewport[3] != layer.viewportHeight;
+    if (layer.valid && !resized && key == layer.key) {
+        return false;
+    }
+
+    layer.valid = false;
+    if (resized) {
+        if (!ResizeLayer(layer, viewport[2], viewport[3])) {
+            return false;
+        }
+    }
+    else {
+        glExt.BindFramebuffer(GL_FRAMEBUFFER, layer.framebuffer);
+    }
+    for (int i = 0; i < 4; i++) {
+        layer.savedViewport[i] = viewport[i];
+    }
+    // The whole viewport, shifted so the layer's pixels land in the texture
+    glViewport(-layer.x, -layer.y, layer.viewportWidth, layer.viewportHeight);
+    layer.key = key;
+    return true;
+}
+
+void EndLayerRender(CachedLayer& layer) {
+    glExt.BindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(layer.savedViewport[0], layer.savedViewport[1], layer.savedViewport[2], layer.savedViewport[3]);
+    layer.valid = true;
+    layer.renders++;
+}
+
+void DrawCachedLayer(const CachedLayer& layer) {
+    if (!layer.valid) {
+        return;
+    }
+    // Corners of the covered pixels in screen coordinates
+    float left = 2.0f * layer.x / layer.viewportWidth - 1.0f;
+    float right = 2.0f * (layer.x + layer.width) / layer.viewportWidth - 1.0f;
+    float bottom = 2.0f * layer.y / layer.viewportHeight - 1.0f;
+    float top = 2.0f * (layer.y + layer.height) / layer.viewportHeight - 1.0f;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT);
+    glDisable(GL_BLEND);  // Opaque: the layer replaces what is underneath
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, layer.texture);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 0.0f);
+    glVertex2f(left, bottom);
+    glTexCoord2f(1.0f, 0.0f);
+    glVertex2f(right, bottom);
+    glTexCoord2f(1.0f, 1.0f);
+    glVertex2f(right, top);
+    glTexCoord2f(0.0f, 1.0f);
+    glVertex2f(left, top);
+    glEnd();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPopAttrib();
+}
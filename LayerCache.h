@@ -0,0 +1,50 @@
+#pragma once
+
+#include "GLIncludes.h"
+
+// Render-to-texture cache for background layers whose pixels rarely change.
+// A layer covers a fixed rectangle of the screen and is drawn into a texture
+// of that many pixels through a framebuffer object; after that each frame
+// only blits the texture with one quad. It is drawn again when the viewport
+// size or its key changes. The key stands for every input the contents
+// depend on (round seed, moon angle, the layer underneath, ...).
+//
+//     if (BeginLayerRender(layer, key)) {
+//         ... draw the layer's contents ...
+//         EndLayerRender(layer);
+//     }
+//     DrawCachedLayer(layer);
+//
+// Contents are drawn with the usual projection and land on the same pixels
+// as they would on screen, so a layer can hold a copy of what lies beneath
+// it (another layer) and be blitted opaque, with the result pixel for pixel
+// what drawing everything directly gives.
+struct CachedLayer {
+    float left, bottom, right, top;  // Area covered, in the -1..1 screen coordinates
+    GLuint framebuffer;
+    GLuint texture;
+    int viewportWidth, viewportHeight;  // Viewport the texture was sized for
+    int x, y, width, height;    // Pixels of the viewport covered, from left, bottom, right and top rounded outwards
+    unsigned long long key;
+    bool valid;                 // Contents match the viewport size and key
+    int renders;                // Times the contents were drawn
+    int savedViewport[4];       // Viewport to restore after rendering
+};
+
+// Whether layers can be cached at all (framebuffer objects are available).
+// Requires LoadGLExtensions.
+bool LayerCacheAvailable();
+
+void InitCachedLayer(CachedLayer& layer, float left, float bottom, float right, float top);
+
+// Make the layer the render target if its contents are out of date for the
+// current viewport size or key. Returns false, leaving the target alone, if
+// they are up to date. The caller then draws the contents and calls
+// EndLayerRender.
+bool BeginLayerRender(CachedLayer& layer, unsigned long long key);
+
+// Go back to drawing into the window
+void EndLayerRender(CachedLayer& layer);
+
+// Draw the layer over its area, replacing what is there
+void DrawCachedLayer(const CachedLayer& layer);
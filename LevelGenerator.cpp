@@ -0,0 +1,72 @@
+#include "LevelGenerator.h"
+
+// Uniform-ish integer in 0..range-1 from the generator's own xorshift64*.
+// Unlike rand() it is the same on every C runtime, and two rounds never
+// disturb each other's sequence.
+static unsigned int RandomBelow(LevelGenerator& generator, unsigned int range) {
+    unsigned long long x = generator.randomState;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    generator.randomState = x;
+    return (unsigned int)((x * 0x2545F4914F6CDD1DULL) >> 32) % range;
+}
+
+LevelGenerator StartLevelGenerator(unsigned int seed) {
+    LevelGenerator generator;
+    generator.randomState = (seed + 1ULL) * 0x9E3779B97F4A7C15ULL;  // Never zero, which xorshift could not leave
+    generator.tick = 0;
+    generator.gameSpeed = kStartGameSpeed;
+    generator.lastObstacleX = 1.0f;
+    generator.hasObstacle = false;
+    return generator;
+}
+
+static void AddEntry(LevelChunk& chunk, long tick, EntityKind kind, EntityLane lane, int variant) {
+    LevelEntry& entry = chunk.entries[chunk.entryCount++];
+    entry.tick = (int)tick;
+    entry.kind = (unsigned char)kind;
+    entry.lane = (unsigned char)lane;
+    entry.variant = (unsigned char)variant;
+}
+
+// One tick of the spawn rules, in the order StepGameWorld applies them
+static void GenerateTick(LevelGenerator& generator, LevelChunk& chunk) {
+    long tick = generator.tick;
+    generator.lastObstacleX -= generator.gameSpeed;  // MoveObstacles, with the same float arithmetic
+
+    if (RandomBelow(generator, 80) == 0) {  // Randomize the spawning frequency
+        // Randomly decide whether to spawn on the ground or in the air
+        AddEntry(chunk, tick, KindCollectible, RandomBelow(generator, 2) == 0 ? LaneGround : LaneRaised, 0);
+    }
+
+    if (RandomBelow(generator, 180) == 0) {  // Randomize the spawning frequency
+        EntityLane lane = RandomBelow(generator, 2) == 0 ? LaneGround : LaneRaised;
+        int type = RandomBelow(generator, 2) + 1;  // 1 for magnet, 2 for invincibility
+        AddEntry(chunk, tick, KindPowerUp, lane, type);
+    }
+
+    generator.gameSpeed = GameSpeedAfterTick(generator.gameSpeed, tick);
+
+    // Randomly spawn obstacles every 1-2 seconds, at least 0.5 apart
+    if (RandomBelow(generator, 50) == 0 && (!generator.hasObstacle || generator.lastObstacleX <= 0.5f)) {
+        // Either on the ground (jumped over) or slightly above the player (ducked under)
+        AddEntry(chunk, tick, KindObstacle, RandomBelow(generator, 3) == 0 ? LaneGround : LaneRaised, 0);
+        generator.lastObstacleX = 1.0f;
+        generator.hasObstacle = true;
+    }
+    generator.tick++;
+}
+
+const int kMaxEntriesPerTick = 3;  // One of each kind
+
+void GenerateLevelChunk(const LevelGenerator& from, LevelChunk& chunk) {
+    chunk.next = from;
+    chunk.firstTick = from.tick;
+    chunk.entryCount = 0;
+    // A chunk that fills up early simply ends early
+    while (chunk.next.tick < chunk.firstTick + kLevelChunkTicks && chunk.entryCount + kMaxEntriesPerTick <= kMaxLevelEntries) {
+        GenerateTick(chunk.next, chunk);
+    }
+    chunk.endTick = chunk.next.tick;
+}
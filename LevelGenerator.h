@@ -0,0 +1,15 @@
+#pragma once
+
+#include "GameWorld.h"
+
+// Procedural level layout. The generator replays the spawn rules of the
+// world tick by tick, mirroring the world's speed and the position of its
+// newest obstacle so spacing rules can be decided ahead of time, and records
+// what spawns when. It never touches a GameWorld, so it can run on any thread
+// (see ChunkFeed.h).
+
+// Generator for the first chunk of a round played with seed
+LevelGenerator StartLevelGenerator(unsigned int seed);
+
+// Lay out the chunk that starts where from left off
+void GenerateLevelChunk(const LevelGenerator& from, LevelChunk& chunk);
@@ -0,0 +1,213 @@
+#include "Logger.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SpscQueue.h"
+
+const int kLogFlushIntervalMs = 10;
+const int kLogLineSize = 512;  // Longer messages are truncated
+
+struct LogRing {
+    LogRing() : dropped(0) {}
+
+    SpscQueue<LogRecord, kLogRingCapacity> records;
+    std::atomic<int> dropped;  // Records lost to a full ring since the last flush
+};
+
+// Rings are never freed: a thread may exit while its records still wait
+static std::mutex ringsMutex;
+static std::vector<LogRing*> rings;
+static thread_local LogRing* threadRing = NULL;
+
+static std::thread writerThread;
+static std::atomic<bool> writerRunning(false);
+
+static std::chrono::steady_clock::time_point LogEpoch() {
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return epoch;
+}
+
+static LogRing* RegisterThreadRing() {
+    LogRing* ring = new LogRing();
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    rings.push_back(ring);
+    return ring;
+}
+
+void LogPush(LogRecord& record) {
+    if (threadRing == NULL) {
+        threadRing = RegisterThreadRing();  // Once per thread
+    }
+    // steady_clock reads a user-space counter on the platforms we ship on
+    record.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - LogEpoch()).count();
+    if (!threadRing->records.push(record)) {
+        threadRing->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void SetLogString(LogRecord& record, LogArg& arg, const char* value) {
+    arg.type = LogArgString;
+    arg.textOffset = record.textUsed;
+    if (value == NULL) {
+        value = "(null)";
+    }
+    int room = kLogTextSize - record.textUsed - 1;  // Less the terminator
+    int length = 0;
+    while (length < room && value[length] != '\0') {
+        length++;
+    }
+    if (room >= 0) {
+        memcpy(record.text + record.textUsed, value, length);
+        record.text[record.textUsed + length] = '\0';
+        record.textUsed += length + 1;
+    }
+}
+
+static bool IsFloatConversion(char conversion) {
+    return conversion != '\0' && strchr("fFeEgGaA", conversion) != NULL;
+}
+
+// printf the format with the recorded arguments. Each conversion is handed to
+// snprintf on its own, with its length modifier replaced to match the stored type.
+static int FormatRecord(const LogRecord& record, char* out, int size) {
+    const char* p = record.format;
+    int used = 0;
+    int next = 0;
+    while (*p != '\0' && used < size - 1) {
+        if (*p != '%') {
+            out[used++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[used++] = '%';
+            p += 2;
+            continue;
+        }
+
+        char spec[32];
+        int length = 0;
+        spec[length++] = *p++;
+        while (*p != '\0' && strchr("-+ #0123456789.", *p) != NULL && length < 24) {
+            spec[length++] = *p++;
+        }
+        while (*p != '\0' && strchr("hlLqjzt", *p) != NULL) {
+            p++;  // Length modifiers describe the caller's type, not the stored one
+        }
+        char conversion = *p;
+        if (conversion != '\0') {
+            p++;
+        }
+        if (next >= record.argCount || conversion == '\0') {
+            out[used++] = '?';  // Missing argument
+            continue;
+        }
+
+        const LogArg& arg = record.args[next++];
+        int written = 0;
+        switch (arg.type) {
+        case LogArgInt:
+            if (IsFloatConversion(conversion)) {
+                spec[length++] = conversion;
+                spec[length] = '\0';
+                written = snprintf(out + used, size - used, spec, (double)arg.intValue);
+            }
+            else if (conversion == 'c') {
+                spec[length++] = 'c';
+                spec[length] = '\0';
+                written = snprintf(out + used, size - used, spec, (int)arg.intValue);
+            }
+            else {
+                spec[length++] = 'l';
+                spec[length++] = 'l';
+                spec[length++] = strchr("diouxX", conversion) != NULL ? conversion : 'd';
+                spec[length] = '\0';
+                written = snprintf(out + used, size - used, spec, arg.intValue);
+            }
+            break;
+        case LogArgFloat:
+            spec[length++] = IsFloatConversion(conversion) ? conversion : 'g';
+            spec[length] = '\0';
+            written = snprintf(out + used, size - used, spec, arg.floatValue);
+            break;
+        case LogArgString:
+            spec[length++] = 's';
+            spec[length] = '\0';
+            written = snprintf(out + used, size - used, spec, arg.textOffset < kLogTextSize ? record.text + arg.textOffset : "");
+            break;
+        }
+        if (written > 0) {
+            used += written < size - used ? written : size - used - 1;  // snprintf truncated the rest
+        }
+    }
+    out[used] = '\0';
+    return used;
+}
+
+static const char* LevelName(LogLevel level) {
+    switch (level) {
+    case LogDebug: return "DEBUG";
+    case LogInfo: return "INFO ";
+    case LogWarn: return "WARN ";
+    default: return "ERROR";
+    }
+}
+
+// Format and write every queued record. Runs on the writer thread, or on the
+// thread calling StopLogger once the writer has stopped.
+static void FlushRings() {
+    static std::vector<LogRing*> snapshot;  // Kept between flushes, so copying the list only allocates when it grew
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        snapshot = rings;
+    }
+
+    char line[kLogLineSize];
+    char message[kLogLineSize];
+    bool wrote = false;
+    for (LogRing* ring : snapshot) {
+        LogRecord record;
+        while (ring->records.pop(record)) {
+            FormatRecord(record, message, sizeof(message));
+            int length = snprintf(line, sizeof(line), "[%10.6f] %s %s\n", record.timestamp / 1e6, LevelName(record.level), message);
+            fwrite(line, 1, length < (int)sizeof(line) ? length : sizeof(line) - 1, stdout);
+            wrote = true;
+        }
+        int dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) {
+            printf("[logger] %d messages dropped\n", dropped);
+            wrote = true;
+        }
+    }
+    if (wrote) {
+        fflush(stdout);
+    }
+}
+
+static void WriterThread() {
+    while (writerRunning.load(std::memory_order_acquire)) {
+        FlushRings();
+        std::this_thread::sleep_for(std::chrono::milliseconds(kLogFlushIntervalMs));
+    }
+}
+
+void StartLogger() {
+    if (writerRunning) {
+        return;
+    }
+    LogEpoch();  // Timestamps count from here at the latest
+    writerRunning = true;
+    writerThread = std::thread(WriterThread);
+}
+
+void StopLogger() {
+    if (writerRunning) {
+        writerRunning = false;
+        writerThread.join();
+    }
+    FlushRings();
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+// Asynchronous logger for code on the game's hot path. A log call copies the
+// format string pointer and up to kMaxLogArgs arguments into a fixed-size
+// record and pushes it into a lock-free ring owned by the calling thread; a
+// background thread formats the records and writes them out. The logging
+// thread never formats, locks or makes a system call (except once, when a
+// thread logs for the first time and registers its ring).
+//
+// Levels below LOG_MIN_LEVEL are removed at compile time, arguments and all:
+//     LOG_INFO("Hit ground obstacle! Lives remaining: %d", lives);
+// Format strings must be string literals. Arguments may be integers, floating
+// point numbers or strings; strings are copied into the record (at most
+// kLogTextSize bytes for all of them together, the rest is cut off), so any
+// buffer may be logged. The newline is added by the logger.
+
+enum LogLevel {
+    LogDebug,
+    LogInfo,
+    LogWarn,
+    LogError
+};
+
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LogInfo  // Build with -DLOG_MIN_LEVEL=LogDebug for per-tick diagnostics
+#endif
+
+const int kMaxLogArgs = 4;
+const int kLogTextSize = 128;  // Bytes for the string arguments of one record, terminators included
+const int kLogRingCapacity = 1024;  // Records per thread; more than that between flushes are dropped
+
+enum LogArgType {
+    LogArgInt,
+    LogArgFloat,
+    LogArgString
+};
+
+struct LogArg {
+    LogArgType type;
+    union {
+        long long intValue;
+        double floatValue;
+        int textOffset;  // Where the string starts in LogRecord::text
+    };
+};
+
+struct LogRecord {
+    long long timestamp;  // Microseconds since the logger was first used
+    const char* format;
+    LogLevel level;
+    int argCount;
+    LogArg args[kMaxLogArgs];
+    int textUsed;
+    char text[kLogTextSize];  // Copies of the string arguments
+};
+
+// Start / stop the thread that formats records and writes them to stdout.
+// Records logged before StartLogger wait in their ring; StopLogger flushes
+// everything still queued.
+void StartLogger();
+void StopLogger();
+
+// Push a record into the calling thread's ring. Use the LOG_ macros instead.
+void LogPush(LogRecord& record);
+
+// Copy a string argument into the record's text, truncated to the space left
+void SetLogString(LogRecord& record, LogArg& arg, const char* value);
+
+inline void SetLogArg(LogRecord&, LogArg& arg, long long value) { arg.type = LogArgInt; arg.intValue = value; }
+inline void SetLogArg(LogRecord& record, LogArg& arg, long value) { SetLogArg(record, arg, (long long)value); }
+inline void SetLogArg(LogRecord& record, LogArg& arg, int value) { SetLogArg(record, arg, (long long)value); }
+inline void SetLogArg(LogRecord& record, LogArg& arg, unsigned int value) { SetLogArg(record, arg, (long long)value); }
+inline void SetLogArg(LogRecord& record, LogArg& arg, bool value) { SetLogArg(record, arg, (long long)value); }
+inline void SetLogArg(LogRecord&, LogArg& arg, double value) { arg.type = LogArgFloat; arg.floatValue = value; }
+inline void SetLogArg(LogRecord& record, LogArg& arg, float value) { SetLogArg(record, arg, (double)value); }
+inline void SetLogArg(LogRecord& record, LogArg& arg, const char* value) { SetLogString(record, arg, value); }
+
+inline void SetLogArgs(LogRecord&, int) {}
+
+template <typename First, typename... Rest>
+inline void SetLogArgs(LogRecord& record, int index, First first, Rest... rest) {
+    SetLogArg(record, record.args[index], first);
+    SetLogArgs(record, index + 1, rest...);
+}
+
+template <typename... Args>
+inline void LogWrite(LogLevel level, const char* format, Args... args) {
+    static_assert(sizeof...(Args) <= kMaxLogArgs, "Too many log arguments");
+    LogRecord record;
+    record.format = format;
+    record.level = level;
+    record.argCount = (int)sizeof...(Args);
+    record.textUsed = 0;
+    SetLogArgs(record, 0, args...);
+    LogPush(record);
+}
+
+// The level test is a constant, so disabled levels compile to nothing
+#define LOG_AT(level, ...) do { if ((level) >= LOG_MIN_LEVEL) { LogWrite((level), __VA_ARGS__); } } while (0)
+#define LOG_DEBUG(...) LOG_AT(LogDebug, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LogInfo, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LogWarn, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LogError, __VA_ARGS__)
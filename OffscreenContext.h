@@ -0,0 +1,9 @@
+#pragma once
+
+// Offscreen desktop GL context through EGL, for drivers that draw game frames
+// without a window or display server (FrameBench.cpp, AllocationTest.cpp).
+
+// Create a pbuffer-backed context of width x height, make it current and set
+// the viewport to it. Prefers a display that needs no window system
+// (EGL_MESA_platform_surfaceless); returns false if none works.
+bool CreateOffscreenContext(int width, int height);
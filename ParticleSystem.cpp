@@ -0,0 +1,262 @@
+#include "ParticleSystem.h"
+
+#include <cmath>
+#include <cstring>
+#include "EntityKernels.h"
+#include "GLExtensions.h"
+
+const float kParticleGravity = 1.5f;  // Units per second squared
+
+// How the particles of each effect start out
+struct EffectStyle {
+    int particles;
+    float minSpeed, maxSpeed;   // Units per second
+    float minAngle, maxAngle;   // Direction in radians, 0 pointing right
+    float minLife, maxLife;     // Seconds
+    unsigned char r, g, b;
+};
+
+static const EffectStyle kEffectStyles[EffectCount] = {
+    { 24, 0.3f, 0.8f, 0.0f, 6.2832f, 0.3f, 0.6f, 255, 230, 50 },    // EffectPickup: yellow, like the collectibles
+    { 64, 0.6f, 0.7f, 0.0f, 6.2832f, 0.5f, 0.8f, 0, 0, 0 },         // EffectPowerUp: color from the power-up type
+    { 48, 0.4f, 1.2f, 0.0f, 6.2832f, 0.4f, 0.9f, 255, 80, 30 },     // EffectHit: red and orange
+    { 32, 0.2f, 0.6f, 1.5708f, 3.1416f, 0.3f, 0.6f, 180, 180, 180 } // EffectKnockback: grey, up and backwards
+};
+
+// Uniform in [0, 1) from the system's own xorshift64*
+static float RandomUnit(ParticleSystem& system) {
+    unsigned long long x = system.randomState;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    system.randomState = x;
+    return (float)((x * 0x2545F4914F6CDD1DULL) >> 40) / (float)(1 << 24);
+}
+
+static float RandomBetween(ParticleSystem& system, float low, float high) {
+    return low + (high - low) * RandomUnit(system);
+}
+
+static unsigned int PackColor(unsigned char r, unsigned char g, unsigned char b) {
+    unsigned char bytes[4] = { r, g, b, 255 };
+    unsigned int packed;
+    memcpy(&packed, bytes, sizeof(packed));
+    return packed;
+}
+
+void InitParticleSystem(ParticleSystem& system) {
+    system.x.assign(kMaxParticles, 0.0f);
+    system.y.assign(kMaxParticles, 0.0f);
+    system.vx.assign(kMaxParticles, 0.0f);
+    system.vy.assign(kMaxParticles, 0.0f);
+    system.life.assign(kMaxParticles, 0.0f);
+    system.fade.assign(kMaxParticles, 0.0f);
+    system.color.assign(kMaxParticles, 0);
+    system.vertices.reserve(kMaxParticles);
+    system.randomState = 0x9E3779B97F4A7C15ULL;
+    system.pointSize = 3.0f;
+    system.drawCalls = 0;
+    ClearParticles(system);
+
+    system.vertexBuffer = 0;
+    if (glExt.hasVertexBuffers) {
+        glExt.GenBuffers(1, &system.vertexBuffer);
+    }
+
+    system.useLayer = glExt.isSoftwareRenderer;
+    system.layerTextures[0] = system.layerTextures[1] = 0;
+    system.layerFrame = 0;
+    system.dirtyLeft = system.dirtyBottom = system.dirtyRight = system.dirtyTop = 0;
+    if (system.useLayer) {
+        system.layer.assign((size_t)kParticleLayerWidth * kParticleLayerHeight, 0);
+        glGenTextures(2, system.layerTextures);
+        for (int i = 0; i < 2; i++) {
+            glBindTexture(GL_TEXTURE_2D, system.layerTextures[i]);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, kParticleLayerWidth, kParticleLayerHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, system.layer.data());
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+}
+
+void ClearParticles(ParticleSystem& system) {
+    system.count = 0;
+    system.droppedParticles = 0;
+}
+
+void EmitParticles(ParticleSystem& system, const ParticleBurst& burst) {
+    const EffectStyle& style = kEffectStyles[burst.effect];
+    unsigned int color = PackColor(style.r, style.g, style.b);
+    if (burst.effect == EffectPowerUp) {
+        color = burst.variant == 1 ? PackColor(255, 60, 60) : PackColor(80, 160, 255);  // Magnet red, invincibility blue
+    }
+    for (int i = 0; i < style.particles; i++) {
+        if (system.count == kMaxParticles) {
+            system.droppedParticles += style.particles - i;
+            return;
+        }
+        int p = system.count++;
+        float angle = RandomBetween(system, style.minAngle, style.maxAngle);
+        float speed = RandomBetween(system, style.minSpeed, style.maxSpeed);
+        float lifetime = RandomBetween(system, style.minLife, style.maxLife);
+        system.x[p] = burst.x;
+        system.y[p] = burst.y;
+        system.vx[p] = cosf(angle) * speed + burst.drift;
+        system.vy[p] = sinf(angle) * speed;
+        system.life[p] = lifetime;
+        system.fade[p] = 1.0f / lifetime;
+        system.color[p] = color;
+    }
+}
+
+void UpdateParticles(ParticleSystem& system, float seconds) {
+    int expired = UpdateParticlesDispatch(system.x.data(), system.y.data(), system.vx.data(), system.vy.data(),
+                                          system.life.data(), system.count, seconds, kParticleGravity);
+    // Fill each hole with the last live particle. Order does not matter for
+    // additive blending, and the columns stay packed for the next pass.
+    for (int i = 0; expired > 0 && i < system.count;) {
+        if (system.life[i] > 0.0f) {
+            i++;
+            continue;
+        }
+        int last = --system.count;
+        system.x[i] = system.x[last];
+        system.y[i] = system.y[last];
+        system.vx[i] = system.vx[last];
+        system.vy[i] = system.vy[last];
+        system.life[i] = system.life[last];
+        system.fade[i] = system.fade[last];
+        system.color[i] = system.color[last];
+        expired--;
+    }
+}
+
+// One point per particle from the streamed vertex buffer
+static void DrawParticlePoints(ParticleSystem& system) {
+    int count = system.count;
+    system.vertices.resize(count);  // Within the reserved pool size, so no allocation
+    BatchVertex* vertices = system.vertices.data();
+    for (int i = 0; i < count; i++) {
+        BatchVertex& vertex = vertices[i];
+        vertex.x = system.x[i];
+        vertex.y = system.y[i];
+        memcpy(&vertex.r, &system.color[i], 3);
+        float opacity = system.life[i] * system.fade[i];
+        vertex.a = (unsigned char)(opacity < 1.0f ? opacity * 255.0f : 255.0f);
+    }
+
+    size_t stride = sizeof(BatchVertex);
+    const char* base;
+    if (system.vertexBuffer != 0) {
+        // Orphan last frame's storage and stream this frame's points in
+        glExt.BindBuffer(GL_ARRAY_BUFFER, system.vertexBuffer);
+        glExt.BufferData(GL_ARRAY_BUFFER, (ptrdiff_t)(count * stride), NULL, GL_STREAM_DRAW);
+        glExt.BufferSubData(GL_ARRAY_BUFFER, 0, (ptrdiff_t)(count * stride), vertices);
+        base = NULL;  // Offsets into the buffer
+    }
+    else {
+        base = (const char*)vertices;
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);  // Additive: overlapping sparks glow brighter
+    glPointSize(system.pointSize);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, (GLsizei)stride, base);
+    glColorPointer(4, GL_UNSIGNED_BYTE, (GLsizei)stride, base + offsetof(BatchVertex, r));
+    glDrawArrays(GL_POINTS, 0, (GLsizei)count);
+    system.drawCalls++;
+
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glPointSize(1.0f);
+    glDisable(GL_BLEND);
+    if (system.vertexBuffer != 0) {
+        glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+// Add every particle's color, weighted by its opacity, into its texel of the
+// layer, then draw the part of the layer that was written as one quad. Only
+// that part is uploaded and drawn, so whatever the texture held outside it
+// from earlier frames never shows.
+static void DrawParticleLayer(ParticleSystem& system) {
+    unsigned int* layer = system.layer.data();
+    for (int row = system.dirtyBottom; row < system.dirtyTop; row++) {
+        memset(layer + row * kParticleLayerWidth + system.dirtyLeft, 0, (system.dirtyRight - system.dirtyLeft) * sizeof(unsigned int));
+    }
+
+    int left = kParticleLayerWidth, bottom = kParticleLayerHeight, right = 0, top = 0;
+    for (int i = 0; i < system.count; i++) {
+        int column = (int)((system.x[i] + 1.0f) * (0.5f * kParticleLayerWidth));
+        int row = (int)((system.y[i] + 1.0f) * (0.5f * kParticleLayerHeight));
+        if ((unsigned int)column >= (unsigned int)kParticleLayerWidth || (unsigned int)row >= (unsigned int)kParticleLayerHeight) {
+            continue;
+        }
+        float opacity = system.life[i] * system.fade[i];
+        int weight = opacity < 1.0f ? (int)(opacity * 256.0f) : 256;
+        unsigned char* texel = (unsigned char*)(layer + row * kParticleLayerWidth + column);
+        const unsigned char* color = (const unsigned char*)&system.color[i];
+        for (int c = 0; c < 3; c++) {
+            int sum = texel[c] + (color[c] * weight >> 8);
+            texel[c] = (unsigned char)(sum < 255 ? sum : 255);
+        }
+        left = column < left ? column : left;
+        right = column >= right ? column + 1 : right;
+        bottom = row < bottom ? row : bottom;
+        top = row >= top ? row + 1 : top;
+    }
+    if (left >= right) {
+        system.dirtyLeft = system.dirtyBottom = system.dirtyRight = system.dirtyTop = 0;
+        return;  // Everything is off screen
+    }
+    system.dirtyLeft = left;
+    system.dirtyBottom = bottom;
+    system.dirtyRight = right;
+    system.dirtyTop = top;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT);
+    glEnable(GL_TEXTURE_2D);
+    system.layerFrame ^= 1;
+    glBindTexture(GL_TEXTURE_2D, system.layerTextures[system.layerFrame]);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, kParticleLayerWidth);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, left, bottom, right - left, top - bottom, GL_RGBA, GL_UNSIGNED_BYTE,
+                    layer + bottom * kParticleLayerWidth + left);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);  // The layer already holds color times opacity
+
+    float u0 = (float)left / kParticleLayerWidth, u1 = (float)right / kParticleLayerWidth;
+    float v0 = (float)bottom / kParticleLayerHeight, v1 = (float)top / kParticleLayerHeight;
+    glBegin(GL_QUADS);
+    glTexCoord2f(u0, v0);
+    glVertex2f(u0 * 2.0f - 1.0f, v0 * 2.0f - 1.0f);
+    glTexCoord2f(u1, v0);
+    glVertex2f(u1 * 2.0f - 1.0f, v0 * 2.0f - 1.0f);
+    glTexCoord2f(u1, v1);
+    glVertex2f(u1 * 2.0f - 1.0f, v1 * 2.0f - 1.0f);
+    glTexCoord2f(u0, v1);
+    glVertex2f(u0 * 2.0f - 1.0f, v1 * 2.0f - 1.0f);
+    glEnd();
+    system.drawCalls++;
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPopAttrib();
+}
+
+void DrawParticles(ParticleSystem& system) {
+    system.drawCalls = 0;
+    if (system.useLayer) {
+        if (system.count > 0 || system.dirtyTop > 0) {
+            DrawParticleLayer(system);  // Also once after the last particle died, to wipe the layer
+        }
+    }
+    else if (system.count > 0) {
+        DrawParticlePoints(system);
+    }
+}
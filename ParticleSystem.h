@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+#include "RenderBatch.h"
+#include "SpscQueue.h"
+
+// Short-lived sparks for pickups, power-ups and hits. Particles are stored
+// column by column and the live ones are packed at the front, so a frame's
+// update is one vectorized pass (UpdateParticlesDispatch in EntityKernels.h)
+// plus filling the holes expired particles leave with the last live one.
+// Drawing writes every particle into one streamed vertex buffer and issues a
+// single GL_POINTS call, however many there are. Software renderers such as
+// Mesa's llvmpipe pay a fixed setup cost per point that alone exceeds a frame
+// at 100k particles, so there the particles are added up into a texture on
+// the CPU instead and drawn as a single quad.
+
+const int kMaxParticles = 131072;
+
+// Software renderers: size of the layer the particles are added up in. Half
+// the default 800x600 window, so a texel covers about 2x2 pixels.
+const int kParticleLayerWidth = 400;
+const int kParticleLayerHeight = 300;
+
+enum ParticleEffect {
+    EffectPickup,     // Sparks where a collectible was picked up
+    EffectPowerUp,    // Ring in the color of the power-up taken
+    EffectHit,        // Debris where an obstacle hit the player
+    EffectKnockback,  // Dust kicked up as the player is pushed back
+    EffectCount
+};
+
+// One burst of an effect, as requested by the simulation
+struct ParticleBurst {
+    ParticleEffect effect;
+    float x, y;        // Center of the burst
+    float drift;       // Horizontal velocity added to every particle, e.g. the scrolling of the world
+    int variant;       // EffectPowerUp: power-up type (1 magnet, 2 invincibility)
+};
+
+const int kParticleBurstCapacity = 256;  // Far more bursts than one frame raises
+typedef SpscQueue<ParticleBurst, kParticleBurstCapacity> ParticleBurstQueue;
+
+struct ParticleSystem {
+    // Columns of kMaxParticles; the live particles are [0, count)
+    std::vector<float> x, y;
+    std::vector<float> vx, vy;          // Units per second
+    std::vector<float> life;            // Seconds left
+    std::vector<float> fade;            // 1 / lifetime: life * fade is the opacity
+    std::vector<unsigned int> color;    // r, g, b bytes in memory order, like BatchVertex
+    int count;
+    long droppedParticles;              // Emitted while the pool was full
+    unsigned long long randomState;     // Private xorshift64* stream
+
+    std::vector<BatchVertex> vertices;  // This frame's points, one per particle
+    GLuint vertexBuffer;                // Streamed once per frame (0 if VBOs are unavailable)
+    float pointSize;                    // Pixels
+    int drawCalls;                      // Draw calls issued by the last DrawParticles
+
+    // Software renderers: the particles are added up here instead of drawn
+    // as points (see the top of this file)
+    bool useLayer;
+    std::vector<unsigned int> layer;    // kParticleLayerWidth x kParticleLayerHeight, bottom row first
+    GLuint layerTextures[2];            // Written by turns, so a frame never waits for the last one's draw
+    int layerFrame;
+    int dirtyLeft, dirtyBottom, dirtyRight, dirtyTop;  // Texels written last frame, right and top exclusive
+};
+
+// Allocate the pool and create the vertex buffer. Requires a current GL
+// context and LoadGLExtensions.
+void InitParticleSystem(ParticleSystem& system);
+
+void ClearParticles(ParticleSystem& system);
+
+// Spawn the particles of one burst. Particles that do not fit are dropped.
+void EmitParticles(ParticleSystem& system, const ParticleBurst& burst);
+
+// Age and move every particle by seconds and remove the expired ones
+void UpdateParticles(ParticleSystem& system, float seconds);
+
+// Draw every particle, blended additively, in one draw call
+void DrawParticles(ParticleSystem& system);
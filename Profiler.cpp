@@ -0,0 +1,134 @@
+#include "Profiler.h"
+
+#include <algorithm>
+
+void InitProfiler(Profiler& profiler) {
+    for (int i = 0; i < PhaseCount; i++) {
+        profiler.pendingSeconds[i] = 0.0;
+    }
+    profiler.pendingAllocations = 0;
+    for (int i = 0; i < kProfileFrames; i++) {
+        profiler.frames[i].sequence.store(0, std::memory_order_relaxed);
+    }
+    profiler.frameCount = 0;
+    profiler.frameStart = std::chrono::steady_clock::now();
+    profiler.overlayVisible = false;
+}
+
+void EndProfileFrame(Profiler& profiler) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    unsigned int count = profiler.frameCount.load(std::memory_order_relaxed);
+    ProfileSlot& slot = profiler.frames[count & (kProfileFrames - 1)];
+    unsigned int sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);  // Odd: being rewritten
+    std::atomic_thread_fence(std::memory_order_release);  // Readers that see a new value also see the odd sequence
+    for (int i = 0; i < PhaseCount; i++) {
+        slot.phaseMs[i].store((float)(profiler.pendingSeconds[i] * 1e3), std::memory_order_relaxed);
+        profiler.pendingSeconds[i] = 0.0;
+    }
+    slot.frameMs.store(std::chrono::duration<float, std::milli>(now - profiler.frameStart).count(), std::memory_order_relaxed);
+    slot.allocations.store(profiler.pendingAllocations, std::memory_order_relaxed);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    profiler.pendingAllocations = 0;
+    profiler.frameStart = now;
+    profiler.frameCount.store(count + 1, std::memory_order_release);
+}
+
+int ProfiledFrameCount(const Profiler& profiler) {
+    unsigned int count = profiler.frameCount.load(std::memory_order_acquire);
+    return count < (unsigned int)kProfileFrames ? (int)count : kProfileFrames;
+}
+
+bool ReadProfileFrame(const Profiler& profiler, int age, ProfileFrame& frame) {
+    unsigned int count = profiler.frameCount.load(std::memory_order_acquire);
+    const ProfileSlot& slot = profiler.frames[(count - 1 - age) & (kProfileFrames - 1)];
+    for (int attempt = 0; attempt < 4; attempt++) {  // A rewrite takes a few stores, so a retry almost always succeeds
+        unsigned int before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        for (int i = 0; i < PhaseCount; i++) {
+            frame.phaseMs[i] = slot.phaseMs[i].load(std::memory_order_relaxed);
+        }
+        frame.frameMs = slot.frameMs.load(std::memory_order_relaxed);
+        frame.allocations = slot.allocations.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);  // The loads above happen before the check below
+        if (slot.sequence.load(std::memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Copy the frames in the ring, newest first, leaving out any being rewritten
+static int SnapshotProfileFrames(const Profiler& profiler, ProfileFrame frames[kProfileFrames]) {
+    int count = ProfiledFrameCount(profiler);
+    int copied = 0;
+    for (int age = 0; age < count; age++) {
+        if (ReadProfileFrame(profiler, age, frames[copied])) {
+            copied++;
+        }
+    }
+    return copied;
+}
+
+int CountProfiledAllocations(const Profiler& profiler, int& framesAllocating) {
+    ProfileFrame frames[kProfileFrames];
+    int count = SnapshotProfileFrames(profiler, frames);
+    int allocations = 0;
+    framesAllocating = 0;
+    for (int i = 0; i < count; i++) {
+        allocations += frames[i].allocations;
+        framesAllocating += frames[i].allocations > 0 ? 1 : 0;
+    }
+    return allocations;
+}
+
+ProfileStats ComputePercentiles(float* samples, int count) {
+    ProfileStats stats = { 0.0f, 0.0f, 0.0f, 0.0f };
+    if (count == 0) {
+        return stats;
+    }
+    // Each nth_element only has to look at the part above the previous one
+    int i50 = count * 50 / 100;
+    int i95 = count * 95 / 100;
+    int i99 = count * 99 / 100;
+    std::nth_element(samples, samples + i50, samples + count);
+    std::nth_element(samples + i50, samples + i95, samples + count);
+    std::nth_element(samples + i95, samples + i99, samples + count);
+    stats.p50 = samples[i50];
+    stats.p95 = samples[i95];
+    stats.p99 = samples[i99];
+    stats.max = *std::max_element(samples + i99, samples + count);
+    return stats;
+}
+
+int ComputeProfileStats(const Profiler& profiler, ProfileStats phases[PhaseCount], ProfileStats& frame) {
+    ProfileFrame frames[kProfileFrames];
+    int count = SnapshotProfileFrames(profiler, frames);
+    float samples[kProfileFrames];
+    for (int phase = 0; phase < PhaseCount; phase++) {
+        for (int i = 0; i < count; i++) {
+            samples[i] = frames[i].phaseMs[phase];
+        }
+        phases[phase] = ComputePercentiles(samples, count);
+    }
+    for (int i = 0; i < count; i++) {
+        samples[i] = frames[i].frameMs;
+    }
+    frame = ComputePercentiles(samples, count);
+    return count;
+}
+
+const char* ProfilePhaseName(ProfilePhase phase) {
+    switch (phase) {
+    case PhaseSimulate: return "Simulate";
+    case PhaseEvents: return "Events";
+    case PhaseBackground: return "Background";
+    case PhaseScene: return "Scene";
+    case PhaseSubmit: return "Submit";
+    case PhaseParticles: return "Particles";
+    case PhaseText: return "Text";
+    default: return "?";
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+// Frame profiler. ProfileScope objects time the phases of a frame; at the end
+// of each frame the per-phase totals are published into a ring of recent
+// frames, from which the overlay computes percentiles. A marker costs two
+// clock reads, so the profiler stays on in release builds. The caller also
+// reports each frame's heap allocations (AllocationCounter.h), which should be
+// zero once the game has warmed up.
+
+enum ProfilePhase {
+    PhaseSimulate,    // StepGameWorld: moving, colliding, spawning (per tick, on the simulation thread)
+    PhaseEvents,      // Event handling and animation updates after each tick
+    PhaseBackground,  // Sky, stars, moon and boundaries
+    PhaseScene,       // Health bar, player and entity instances
+    PhaseSubmit,      // Uploading and drawing the batch and instances
+    PhaseParticles,   // Emitting, updating and drawing particles
+    PhaseText,        // HUD text
+    PhaseCount
+};
+
+const int kProfileFrames = 256;  // Frames kept for statistics and the graph (power of two)
+
+struct ProfileFrame {
+    float phaseMs[PhaseCount];
+    float frameMs;  // Time since the previous frame ended
+    int allocations;  // Heap allocations the frame made
+};
+
+// One frame in the ring, guarded by a sequence number (a seqlock): odd while
+// the writer rewrites the slot, even once it is complete. A reader copies the
+// values and keeps them only if the sequence was even and did not change.
+struct ProfileSlot {
+    std::atomic<unsigned int> sequence;
+    std::atomic<float> phaseMs[PhaseCount];
+    std::atomic<float> frameMs;
+    std::atomic<int> allocations;
+};
+
+struct Profiler {
+    // Written only by the thread that runs the frame; any thread may read the
+    // ring without a lock (see ProfileSlot). frameCount is published after the
+    // frame it counts is complete.
+    ProfileSlot frames[kProfileFrames];
+    std::atomic<unsigned int> frameCount;
+
+    double pendingSeconds[PhaseCount];  // Totals for the frame in progress
+    int pendingAllocations;  // Set by the caller before EndProfileFrame
+    std::chrono::steady_clock::time_point frameStart;
+    bool overlayVisible;
+};
+
+struct ProfileStats {
+    float p50, p95, p99, max;
+};
+
+void InitProfiler(Profiler& profiler);
+
+// Times the enclosing block and adds it to the phase. A phase may run several
+// times in one frame; its times add up.
+class ProfileScope {
+public:
+    ProfileScope(Profiler& profiler, ProfilePhase phase)
+        : profiler(profiler), phase(phase), start(std::chrono::steady_clock::now()) {}
+
+    ~ProfileScope() {
+        profiler.pendingSeconds[phase] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    Profiler& profiler;
+    ProfilePhase phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Publish the frame in progress and start the next one
+void EndProfileFrame(Profiler& profiler);
+
+// Number of frames in the ring (at most kProfileFrames)
+int ProfiledFrameCount(const Profiler& profiler);
+
+// Copy a recent frame: age 0 is the last one published. False if the writer
+// kept rewriting the slot while it was read; callers skip that frame.
+bool ReadProfileFrame(const Profiler& profiler, int age, ProfileFrame& frame);
+
+// Percentiles over the frames in the ring, per phase and for the whole frame.
+// Returns the number of frames they cover (frames being rewritten are left out).
+int ComputeProfileStats(const Profiler& profiler, ProfileStats phases[PhaseCount], ProfileStats& frame);
+
+// Heap allocations of the frames in the ring, and in how many of them there were any
+int CountProfiledAllocations(const Profiler& profiler, int& framesAllocating);
+
+// Percentiles of any samples, which get reordered
+ProfileStats ComputePercentiles(float* samples, int count);
+
+const char* ProfilePhaseName(ProfilePhase phase);
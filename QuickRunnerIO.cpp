@@ -1,142 +1,153 @@
 #include <ctime>
 #include <cstdio>
 #include <cmath>
-#include <vector>
 #include <cstdlib>
-#include <glut.h>
-#include <windows.h>     // For Windows API and PlaySound
-#include <mmsystem.h>    // For PlaySound (winmm.libneeded)
-#define M_PI 3.14159265358979323846
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "GLIncludes.h"
+#include "GameWorld.h"
+#include "FixedTimestep.h"
+#include "Starfield.h"
+#include "GLExtensions.h"
+#include "RenderBatch.h"
+#include "ShapeCache.h"
+#include "InstanceRenderer.h"
+#include "LayerCache.h"
+#include "ParticleSystem.h"
+#include "TextRenderer.h"
+#include "AllocationCounter.h"
+#include "AudioMixer.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "InputQueue.h"
+#include "InputPolicy.h"
+#include "Replay.h"
+#include "ChunkFeed.h"
+#include "TripleBuffer.h"
+#include "QuickRunnerIO.h"
 
 
-// Function to play background music
-static void playMusic(const char* filePath) {
-    if (!PlaySoundA(filePath, NULL, SND_FILENAME | SND_ASYNC | SND_LOOP)) {
-        printf("Failed to play sound!\n");  // Debugging message
-    }
-}
-
-// Function to stop any currently playing music
-static void stopMusic() {
-    PlaySound(NULL, NULL, SND_ASYNC);
-}
-
-// Function to play sound effects
-static void playSoundEffect(const char* filePath) {
-    PlaySoundA(filePath, NULL, SND_FILENAME | SND_ASYNC);
-}
-
 // Global Variables
-static float playerX = -0.8f;  // Starting X position for the player
-float playerY = 0.0f;        // Player's Y position (for jumping)
-bool isJumping = false;      // Whether the player is in the air
-bool isDucking = false;      // Whether the player is ducking
-float jumpVelocity = 0.05f;  // Velocity for jumping
-float gravity = 0.002f;      // Gravity effect
-float collectibleX = 1.5f;   // X position of the collectible
-float collectibleY = 0.0f;  // Ground level, adjust Y position to match the ground
-bool collectibleActive = true; // Whether the collectible is active or has been collected
-float powerUpX = 1.5f;       // X position of a power-up
-float gameSpeed = 0.01f;     // Speed of the game (increases over time)
-int lives = 5;               // Player lives
-int score = 0;               // Player score
-int gameTime = 60;          // Total game time (120 seconds, or 2 minutes)
-clock_t startTime;           // Start time of the game
-float powerUpRotationAngle = 0.0f;  // Rotation angle for power-ups
-float collectiblePulseScale = 1.0f;  // Scale factor for collectibles
-bool increasingScale = true;  // To alternate scaling for the pulse effect
-bool hasMagnet = false;           // Track if player has the magnet power-up
-bool isInvincible = false;        // Track if player is invincible
-clock_t powerUpStartTime;        // Track when the power-up was acquired
-bool isKnockedBack = false;
-bool isReadjusting = false;
-float knockbackAmount = 0.05f;  // The amount of knockback
-float readjustSpeed = 0.01f;    // Speed to move the player back to the original position
-float knockbackStrength = 0.02f;  // How much the player is knocked back
-int knockbackDuration = 30;       // How many frames the knockback lasts
-int knockbackTimer = 0;           // Timer to keep track of knockback
-int starSpawnCounter = 0;  // Counter for star spawning
-static bool gameEnd = false;   // Flag for when the timer runs out
-static bool gameLose = false;  // Flag for when player loses all health
-
-struct Star {
-    float x;
-    float y;
-    float size;
+// The sim* state, the timestep and the consumer side of the input queue
+// belong to the simulation thread; everything GL belongs to the GLUT thread.
+// The simulation hands its state over in snapshots (see WorldSnapshot).
+static GameWorld simWorld;        // Simulation state (player, entities, score, timers)
+static ChunkFeed chunkFeed;  // Lays out the level ahead of the world on its own thread
+static InputQueue inputQueue;  // Timestamped key events from the GLUT callbacks to the ticks
+static FixedTimestep timestep;  // Converts real time into simulation ticks
+static std::thread simulationThread;
+static std::atomic<bool> simulationRunning(false);
+static float renderAlpha = 1.0f;  // Progress between the last two ticks when drawing
+static AudioMixer audio;        // Music and sound effects, mixed on their own thread
+static RenderBatch batch;  // All shapes of a frame, submitted in a few draw calls
+static InstanceRenderer instancer;  // Obstacles, collectibles and power-ups, one draw call per mesh
+
+// How each kind of entity is drawn: the instance mesh for the value of one
+// of its components, and how it is animated
+enum EntityAnimation {
+    AnimateNone,
+    AnimatePulse,   // Scaled by the collectible pulse
+    AnimateSpin     // Rotated by the power-up angle, at 1.5 times its width
 };
 
-std::vector<Star> stars;  // Vector to hold stars
-
-// Obstacle Structure
-struct Obstacle {
-    float x;  // X position
-    float y;  // Y position (ground or slightly above)
-    float width, height;  // Dimensions of the obstacle
-    bool hasHitPlayer = false;  // Track if this obstacle has already hit the player
+struct EntityLook {
+    Component meshBy;   // Component whose value indexes meshes, or kComponentCount to always use meshes[0]
+    int meshes[3];
+    EntityAnimation animation;
 };
 
-std::vector<Obstacle> obstacles;  // List of obstacles
-
-struct Collectible {
-    float x, y;        // Position of the collectible
-    float size;        // Size of the collectible
-    bool active;       // Whether the collectible is active or collected
+static EntityLook entityLooks[kEntityKindCount];  // Filled in by BuildEntityMeshes
+static CachedLayer sceneryLayer;  // Frame, stars, asteroids and ground, drawn again only for a new sky or size
+static CachedLayer moonLayer;  // The moon and the scenery around it, drawn again as the moon turns
+static ParticleSystem particles;  // Pickup, power-up and hit effects
+static ParticleBurstQueue particleBursts;  // Effects raised by the ticks, for the GLUT thread to emit
+static std::chrono::steady_clock::time_point lastParticleUpdate;
+static GlyphAtlas glyphAtlas;  // HUD and end screen fonts, baked into a texture on the first frame
+static int hudFont, titleFont;  // Atlas font indices
+static TextLabel scoreLabel, timeLabel, endScreenLabel;  // Cached text quads
+static Profiler profiler;        // Per-phase frame timings, shown with 'f'
+static Profiler tickProfiler;    // Simulate and Events timings, one profiler frame per tick
+static TextLabel profilerLabel;
+static InputLatency inputLatency;  // Key-to-present times, shown with the profiler
+static Replay recording;  // Round being recorded with --record
+static const char* recordPath = NULL;
+static Replay playback;  // Round being played back with --replay, instead of the keyboard
+static bool replaying = false;
+static long replayTick = 0;  // Next input of the playback
+static double timeScale = 1.0;  // Game time per real time, from --speed
+static bool demo = false;  // Attract mode (--demo): the lookahead bot plays round after round
+static bool hudTextEnabled = true;  // HUD text needs GLUT's fonts, so offscreen benchmarks turn it off
+
+// Animation values advanced once per tick, with the game speed
+struct AnimationState {
+    float powerUpRotationAngle;  // Rotation angle for power-ups
+    float collectiblePulseScale;  // Scale factor for collectibles
+    float prevPowerUpRotationAngle;  // Animation values before the last tick
+    float prevCollectiblePulseScale;
+    bool increasingScale;  // To alternate scaling for the pulse effect
 };
-
-std::vector<Collectible> collectibles;  // Store multiple 
-
-struct PowerUp {
-    float x, y;        // Position of the power-up
-    float size;        // Size of the power-up
-    bool active;       // Whether the power-up is active
-    int type;          // Type of power-up (1 for magnet, 2 for invincibility)
+static AnimationState simAnimation = { 0.0f, 1.0f, 0.0f, 1.0f, true };
+
+// Everything a frame draws, as of the last tick. The simulation thread fills
+// one after each batch of ticks; the GLUT thread draws the newest one and
+// never touches the live world, so neither side waits for the other.
+struct WorldSnapshot {
+    GameWorld world;  // Without its chunk feed
+    AnimationState animation;
+    InputStamp input;  // Newest input the ticks have consumed
+    std::chrono::steady_clock::time_point tickTime;  // When the last tick was due
+    double tickSeconds;
 };
+static TripleBuffer<WorldSnapshot> snapshots;
+static const WorldSnapshot* shown;  // Snapshot of the frame being drawn
 
-std::vector<PowerUp> powerUps;  // Store multiple power-ups
+const int kMaxVisibleStars = 256;  // Upper bound on StarfieldBudget for the sky below
+static Starfield starfield;  // Procedural sky, no per-star storage
+static StarfieldStar visibleStars[kMaxVisibleStars];  // Scratch space for the stars of one frame
 
+// Blend a value from the previous tick towards the current one for smooth drawing
+static float Interpolate(float previous, float current) {
+    return previous + (current - previous) * renderAlpha;
+}
 
 
 // Function to draw a heart shape
 static void DrawHeart(float x, float y, float size) {
-    glBegin(GL_POLYGON);
-    glColor3f(1.0f, 0.0f, 0.0f);  // Red color for health
-
-    // Heart shape vertices
-    for (float angle = 0; angle < 2 * M_PI; angle += 0.01f) {
-        float dx = size * (16 * pow(sin(angle), 3));
-        float dy = size * (13 * cos(angle) - 5 * cos(2 * angle) - 2 * cos(3 * angle) - cos(4 * angle));
-        glVertex2f(x + dx, y + dy);
-    }
-
-    glEnd();
+    const Shape& heart = GetShape(ShapeHeart);
+    BatchColor(batch, 1.0f, 0.0f, 0.0f);  // Red color for health
+    BatchShape(batch, GL_POLYGON, heart.points, heart.count, x, y, size);
 }
 
 // Function to draw the health bar (heart shape)
 static void DrawHealthBar() {
-    glPushMatrix();
-    glTranslatef(-0.9f, 0.8f, 0.0f);  // Position at the top-left
+    const GameWorld& world = shown->world;
+    BatchPushMatrix(batch);
+    BatchTranslate(batch, -0.9f, 0.8f);  // Position at the top-left
 
     // Draw lives using heart shapes (one for each life)
-    for (int i = 0; i < lives; i++) {
+    for (int i = 0; i < world.lives; i++) {
         DrawHeart(i * 0.17f, 0.0f, 0.005f);  // Increased spacing to 0.08f
     }
 
-    glPopMatrix();
+    BatchPopMatrix(batch);
 }
 
-// Function to display score and time at the top-right of the screen
-static void DrawScoreAndTime() {
+// Score and time drawn straight from the GLUT font, used when the glyph atlas is unavailable
+static void DrawScoreAndTimeBitmap() {
+    const GameWorld& world = shown->world;
 
     // Set the text color to a bright color (like yellow or white) for better visibility
     glColor3f(1.0f, 1.0f, 0.0f);  // Yellow color for score and time
 
     // Format score text
     char scoreText[50];
-    sprintf(scoreText, "Score: %d", score);
+    sprintf(scoreText, "Score: %d", world.score);
 
     // Format time text
     char timeText[50];
-    sprintf(timeText, "Time: %d", gameTime);
+    sprintf(timeText, "Time: %d", world.gameTime);
 
     // Display score on the top-right
     glRasterPos2f(0.5f, 0.85f);  // Position for score
@@ -163,189 +174,187 @@ static void DrawScoreAndTime() {
     }
 }
 
+// Rebuild a HUD label only when the number it shows has changed
+static void UpdateHudLabel(TextLabel& label, const char* format, int value, float x, float y) {
+    if (TextLabelIsCurrent(label, glyphAtlas, value)) {
+        return;
+    }
+    char text[50];
+    sprintf(text, format, value);
+    ResetTextLabel(label, glyphAtlas, value);
+    AppendText(label, glyphAtlas, hudFont, text, x, y, 1.0f, 1.0f, 0.0f);  // Yellow color for score and time
+    AppendText(label, glyphAtlas, hudFont, text, x + 0.005f, y + 0.005f, 1.0f, 1.0f, 1.0f);  // White glow, offset, in the same draw
+}
+
+// Function to display score and time at the top-right of the screen
+static void DrawScoreAndTime() {
+    const GameWorld& world = shown->world;
+    if (!hudTextEnabled) {
+        return;
+    }
+    if (!glyphAtlas.baked) {
+        DrawScoreAndTimeBitmap();
+        return;
+    }
+    UpdateHudLabel(scoreLabel, "Score: %d", world.score, 0.5f, 0.85f);  // Score on the top-right
+    UpdateHudLabel(timeLabel, "Time: %d", world.gameTime, 0.8f, 0.85f);  // Time next to the score
+    DrawTextLabel(glyphAtlas, scoreLabel);
+    DrawTextLabel(glyphAtlas, timeLabel);
+}
+
 // Function to draw the player as an astronaut
 static void DrawPlayer() {
-    glPushMatrix();
-    glTranslatef(playerX - 0.1f, playerY - 0.7f, 0.0f);  // Adjust playerY for jumping and standing on the ground
-
-    if (isDucking) {
-        glScalef(1.0f, 0.5f, 1.0f);  // Shrink player when ducking
+    const GameWorld& world = shown->world;
+    BatchPushMatrix(batch);
+    float playerX = Interpolate(world.prevPlayerX, world.playerX);
+    float playerY = Interpolate(world.prevPlayerY, world.playerY);
+    BatchTranslate(batch, playerX - 0.1f, playerY - 0.7f);  // Adjust playerY for jumping and standing on the ground
+
+    if (world.isDucking) {
+        BatchScale(batch, 1.0f, 0.5f);  // Shrink player when ducking
     }
 
     // Draw the astronaut suit (body)
-    glBegin(GL_QUADS);  // Body (quad)
-    glColor3f(0.0f, 0.0f, 1.0f);  // Blue color for the suit
-    glVertex2f(-0.05f, 0.0f);  // Lower vertex aligned with the ground
-    glVertex2f(0.05f, 0.0f);
-    glVertex2f(0.05f, 0.1f);
-    glVertex2f(-0.05f, 0.1f);
-    glEnd();
+    BatchBegin(batch, GL_QUADS);  // Body (quad)
+    BatchColor(batch, 0.0f, 0.0f, 1.0f);  // Blue color for the suit
+    BatchVertex2f(batch, -0.05f, 0.0f);  // Lower vertex aligned with the ground
+    BatchVertex2f(batch, 0.05f, 0.0f);
+    BatchVertex2f(batch, 0.05f, 0.1f);
+    BatchVertex2f(batch, -0.05f, 0.1f);
+    BatchEnd(batch);
 
     // Draw the helmet (cap) - a larger arc to simulate a dome shape
-    glBegin(GL_TRIANGLE_FAN);  // Helmet (dome)
-    glColor3f(1.0f, 1.0f, 1.0f);  // White color for the helmet
-    glVertex2f(0.0f, 0.15f);  // Center of the helmet
-    for (int i = 0; i <= 30; i++) {
-        float theta = (float)i / 30.0f * 3.14159f;  // Half circle for the dome
-        glVertex2f(0.04f * cos(theta), 0.15f + 0.04f * sin(theta));  // Radius of 0.04
-    }
-    glEnd();
+    const Shape& helmet = GetShape(ShapeHelmet);
+    BatchColor(batch, 1.0f, 1.0f, 1.0f);  // White color for the helmet
+    BatchShape(batch, GL_TRIANGLE_FAN, helmet.points, helmet.count, 0.0f, 0.15f, 0.04f);  // Radius of 0.04
 
     // Draw the head (skin)
-    glBegin(GL_TRIANGLES);  // Head (triangle)
-    glColor3f(1.0f, 0.85f, 0.7f);  // Skin color
-    glVertex2f(-0.03f, 0.1f);
-    glVertex2f(0.03f, 0.1f);
-    glVertex2f(0.0f, 0.15f);
-    glEnd();
+    BatchBegin(batch, GL_TRIANGLES);  // Head (triangle)
+    BatchColor(batch, 1.0f, 0.85f, 0.7f);  // Skin color
+    BatchVertex2f(batch, -0.03f, 0.1f);
+    BatchVertex2f(batch, 0.03f, 0.1f);
+    BatchVertex2f(batch, 0.0f, 0.15f);
+    BatchEnd(batch);
 
     // Draw the visor (optional, can be a simple rectangle)
-    glBegin(GL_QUADS);  // Visor
-    glColor3f(0.0f, 0.0f, 0.0f);  // Black color for the visor
-    glVertex2f(-0.025f, 0.1f);
-    glVertex2f(0.025f, 0.1f);
-    glVertex2f(0.015f, 0.12f);
-    glVertex2f(-0.015f, 0.12f);
-    glEnd();
+    BatchBegin(batch, GL_QUADS);  // Visor
+    BatchColor(batch, 0.0f, 0.0f, 0.0f);  // Black color for the visor
+    BatchVertex2f(batch, -0.025f, 0.1f);
+    BatchVertex2f(batch, 0.025f, 0.1f);
+    BatchVertex2f(batch, 0.015f, 0.12f);
+    BatchVertex2f(batch, -0.015f, 0.12f);
+    BatchEnd(batch);
 
     // Draw a stripe on the suit
-    glBegin(GL_QUADS);  // Stripe
-    glColor3f(1.0f, 0.0f, 0.0f);  // Red color for the stripe
-    glVertex2f(-0.05f, 0.05f);
-    glVertex2f(0.05f, 0.05f);
-    glVertex2f(0.05f, 0.06f);
-    glVertex2f(-0.05f, 0.06f);
-    glEnd();
-
-    glPopMatrix();
+    BatchBegin(batch, GL_QUADS);  // Stripe
+    BatchColor(batch, 1.0f, 0.0f, 0.0f);  // Red color for the stripe
+    BatchVertex2f(batch, -0.05f, 0.05f);
+    BatchVertex2f(batch, 0.05f, 0.05f);
+    BatchVertex2f(batch, 0.05f, 0.06f);
+    BatchVertex2f(batch, -0.05f, 0.06f);
+    BatchEnd(batch);
+
+    BatchPopMatrix(batch);
 }
 
-static void DrawPowerUps() {
-    for (const auto& powerUp : powerUps) {
-        if (powerUp.active) {
-            glPushMatrix();
-            glTranslatef(powerUp.x, powerUp.y, 0.0f);
-            glScalef(powerUp.size * 1.5f, powerUp.size * 1.5f, 1.0f);  // Increase the scaling factor
-
-            // Rotate the power-up around its center
-            glRotatef(powerUpRotationAngle, 0.0f, 0.0f, 1.0f);
-
-            // Draw magnet power-up
-            if (powerUp.type == 1) {
-                glColor3f(1.0f, 0.0f, 0.0f);  // Red color for magnet
-
-                // 1. Draw left rectangle (left bar of the magnet)
-                glBegin(GL_QUADS);
-                glVertex2f(-0.8f, 0.0f);  // Bottom-left
-                glVertex2f(-0.6f, 0.0f);  // Bottom-right
-                glVertex2f(-0.6f, 1.0f);  // Top-right
-                glVertex2f(-0.8f, 1.0f);  // Top-left
-                glEnd();
-
-                // 2. Draw right rectangle (right bar of the magnet)
-                glBegin(GL_QUADS);
-                glVertex2f(0.6f, 0.0f);  // Bottom-left
-                glVertex2f(0.8f, 0.0f);  // Bottom-right
-                glVertex2f(0.8f, 1.0f);  // Top-right
-                glVertex2f(0.6f, 1.0f);  // Top-left
-                glEnd();
-
-                glColor3f(1.0f, 1.0f, 0.0f);  // Yellow color for the top curves
-
-                // 3. Draw left arc (curve on the left)
-                glBegin(GL_TRIANGLE_FAN);
-                glVertex2f(-0.7f, 1.0f);  // Center of the curve
-                for (int i = 180; i <= 270; i += 5) {
-                    float theta = i * M_PI / 180.0f;
-                    glVertex2f(-0.7f + 0.3f * cos(theta), 1.0f + 0.3f * sin(theta));  // Draw arc
-                }
-                glEnd();
-
-                // 4. Draw right arc (curve on the right)
-                glBegin(GL_TRIANGLE_FAN);
-                glVertex2f(0.7f, 1.0f);  // Center of the curve
-                for (int i = 270; i <= 360; i += 5) {
-                    float theta = i * M_PI / 180.0f;
-                    glVertex2f(0.7f + 0.3f * cos(theta), 1.0f + 0.3f * sin(theta));  // Draw arc
-                }
-                glEnd();
-            }
-
-            // Draw invincibility power-up (green upward arrow)
-            else if (powerUp.type == 2) {
-                glColor3f(0.0f, 1.0f, 0.0f);  // Green color for invincibility
-
-                // 1. Draw arrowhead (triangle)
-                glBegin(GL_TRIANGLES);
-                glVertex2f(-0.6f, 0.0f);  // Left point
-                glVertex2f(0.6f, 0.0f);   // Right point
-                glVertex2f(0.0f, 1.2f);   // Top point
-                glEnd();
-
-                // 2. Draw arrow body (center rectangle)
-                glBegin(GL_QUADS);
-                glVertex2f(-0.3f, -0.6f);
-                glVertex2f(0.3f, -0.6f);
-                glVertex2f(0.3f, 0.0f);
-                glVertex2f(-0.3f, 0.0f);
-                glEnd();
-
-                // 3. Draw left wing (rectangle on the left)
-                glBegin(GL_QUADS);
-                glVertex2f(-0.8f, -0.3f);
-                glVertex2f(-0.3f, -0.3f);
-                glVertex2f(-0.3f, -0.6f);
-                glVertex2f(-0.8f, -0.6f);
-                glEnd();
-
-                // 4. Draw right wing (rectangle on the right)
-                glBegin(GL_QUADS);
-                glVertex2f(0.3f, -0.3f);
-                glVertex2f(0.8f, -0.3f);
-                glVertex2f(0.8f, -0.6f);
-                glVertex2f(0.3f, -0.6f);
-                glEnd();
-            }
+// Magnet (type 1) or invincibility (type 2) shape around the origin, in units
+// of 1.5 power-up sizes
+static void DrawPowerUpShape(RenderBatch& target, int type) {
+    // Draw magnet power-up
+    if (type == 1) {
+        BatchColor(target, 1.0f, 0.0f, 0.0f);  // Red color for magnet
+
+        // 1. Draw left rectangle (left bar of the magnet)
+        BatchBegin(target, GL_QUADS);
+        BatchVertex2f(target, -0.8f, 0.0f);  // Bottom-left
+        BatchVertex2f(target, -0.6f, 0.0f);  // Bottom-right
+        BatchVertex2f(target, -0.6f, 1.0f);  // Top-right
+        BatchVertex2f(target, -0.8f, 1.0f);  // Top-left
+        BatchEnd(target);
+
+        // 2. Draw right rectangle (right bar of the magnet)
+        BatchBegin(target, GL_QUADS);
+        BatchVertex2f(target, 0.6f, 0.0f);  // Bottom-left
+        BatchVertex2f(target, 0.8f, 0.0f);  // Bottom-right
+        BatchVertex2f(target, 0.8f, 1.0f);  // Top-right
+        BatchVertex2f(target, 0.6f, 1.0f);  // Top-left
+        BatchEnd(target);
+
+        BatchColor(target, 1.0f, 1.0f, 0.0f);  // Yellow color for the top curves
+
+        // 3. Draw left arc (curve on the left)
+        const Shape& leftArc = GetShape(ShapeMagnetLeftArc);
+        BatchShape(target, GL_TRIANGLE_FAN, leftArc.points, leftArc.count, -0.7f, 1.0f, 0.3f);
+
+        // 4. Draw right arc (curve on the right)
+        const Shape& rightArc = GetShape(ShapeMagnetRightArc);
+        BatchShape(target, GL_TRIANGLE_FAN, rightArc.points, rightArc.count, 0.7f, 1.0f, 0.3f);
+    }
 
-            glPopMatrix();
-        }
+    // Draw invincibility power-up (green upward arrow)
+    else if (type == 2) {
+        BatchColor(target, 0.0f, 1.0f, 0.0f);  // Green color for invincibility
+
+        // 1. Draw arrowhead (triangle)
+        BatchBegin(target, GL_TRIANGLES);
+        BatchVertex2f(target, -0.6f, 0.0f);  // Left point
+        BatchVertex2f(target, 0.6f, 0.0f);   // Right point
+        BatchVertex2f(target, 0.0f, 1.2f);   // Top point
+        BatchEnd(target);
+
+        // 2. Draw arrow body (center rectangle)
+        BatchBegin(target, GL_QUADS);
+        BatchVertex2f(target, -0.3f, -0.6f);
+        BatchVertex2f(target, 0.3f, -0.6f);
+        BatchVertex2f(target, 0.3f, 0.0f);
+        BatchVertex2f(target, -0.3f, 0.0f);
+        BatchEnd(target);
+
+        // 3. Draw left wing (rectangle on the left)
+        BatchBegin(target, GL_QUADS);
+        BatchVertex2f(target, -0.8f, -0.3f);
+        BatchVertex2f(target, -0.3f, -0.3f);
+        BatchVertex2f(target, -0.3f, -0.6f);
+        BatchVertex2f(target, -0.8f, -0.6f);
+        BatchEnd(target);
+
+        // 4. Draw right wing (rectangle on the right)
+        BatchBegin(target, GL_QUADS);
+        BatchVertex2f(target, 0.3f, -0.3f);
+        BatchVertex2f(target, 0.8f, -0.3f);
+        BatchVertex2f(target, 0.8f, -0.6f);
+        BatchVertex2f(target, 0.3f, -0.6f);
+        BatchEnd(target);
     }
 }
 
-// Function to draw obstacles
-static void DrawObstacles() {
-    for (auto& obstacle : obstacles) {
-        glPushMatrix();
-        glTranslatef(obstacle.x, obstacle.y, 0.0f);
-
-        // Draw the main body of the obstacle (a rectangle)
-        glBegin(GL_QUADS);
-        glColor3f(1.0f, 0.0f, 0.0f);  // Red color for the obstacle
-        glVertex2f(0.0f, 0.0f);
-        glVertex2f(obstacle.width, 0.0f);
-        glVertex2f(obstacle.width, obstacle.height);
-        glVertex2f(0.0f, obstacle.height);
-        glEnd();
-
-        // Draw a shadow beneath the obstacle
-        glBegin(GL_QUADS);
-        glColor4f(0.0f, 0.0f, 0.0f, 0.5f);  // Semi-transparent black for shadow
-        glVertex2f(-0.05f, -0.02f);  // Shadow offset to give depth
-        glVertex2f(obstacle.width + 0.05f, -0.02f);
-        glVertex2f(obstacle.width + 0.05f, -0.05f);
-        glVertex2f(-0.05f, -0.05f);
-        glEnd();
-
-        // Draw an additional decorative element (like a stripe or a star on the obstacle)
-        glBegin(GL_TRIANGLES);
-        glColor3f(1.0f, 0.85f, 0.0f);  // Yellow stripe color
-        glVertex2f(obstacle.width / 2, obstacle.height); // Top point
-        glVertex2f(obstacle.width / 4, obstacle.height - 0.1f); // Bottom left point
-        glVertex2f(3 * obstacle.width / 4, obstacle.height - 0.1f); // Bottom right point
-        glEnd();
-
-        glPopMatrix();
-    }
+// Obstacle shape with its bottom-left corner at the origin
+static void DrawObstacleShape(RenderBatch& target, float width, float height) {
+    // Draw the main body of the obstacle (a rectangle)
+    BatchBegin(target, GL_QUADS);
+    BatchColor(target, 1.0f, 0.0f, 0.0f);  // Red color for the obstacle
+    BatchVertex2f(target, 0.0f, 0.0f);
+    BatchVertex2f(target, width, 0.0f);
+    BatchVertex2f(target, width, height);
+    BatchVertex2f(target, 0.0f, height);
+    BatchEnd(target);
+
+    // Draw a shadow beneath the obstacle
+    BatchBegin(target, GL_QUADS);
+    BatchColor(target, 0.0f, 0.0f, 0.0f, 0.5f);  // Semi-transparent black for shadow
+    BatchVertex2f(target, -0.05f, -0.02f);  // Shadow offset to give depth
+    BatchVertex2f(target, width + 0.05f, -0.02f);
+    BatchVertex2f(target, width + 0.05f, -0.05f);
+    BatchVertex2f(target, -0.05f, -0.05f);
+    BatchEnd(target);
+
+    // Draw an additional decorative element (like a stripe or a star on the obstacle)
+    BatchBegin(target, GL_TRIANGLES);
+    BatchColor(target, 1.0f, 0.85f, 0.0f);  // Yellow stripe color
+    BatchVertex2f(target, width / 2, height); // Top point
+    BatchVertex2f(target, width / 4, height - 0.1f); // Bottom left point
+    BatchVertex2f(target, 3 * width / 4, height - 0.1f); // Bottom right point
+    BatchEnd(target);
 }
 
 /*static void DrawCollectibles() {
@@ -376,108 +385,149 @@ static void DrawObstacles() {
 
 // Function to draw a star (as a point or small polygon)
 // Function to draw a star
-static void DrawStar(float x, float y, float size) {
-    glBegin(GL_TRIANGLES);
-    glColor3f(1.0f, 1.0f, 1.0f);  // White color for the star
-    for (int i = 0; i < 5; i++) {
-        float angle = i * (2.0f * M_PI / 5);  // Angle for each vertex
-        float xOuter = x + size * cos(angle);  // Outer vertex X
-        float yOuter = y + size * sin(angle);  // Outer vertex Y
-
-        angle += M_PI / 5;  // Adjust for inner vertex
-        float xInner = x + (size * 0.5f) * cos(angle);  // Inner vertex X
-        float yInner = y + (size * 0.5f) * sin(angle);  // Inner vertex Y
-
-        glVertex2f(xOuter, yOuter);  // Outer vertex
-        glVertex2f(xInner, yInner);   // Inner vertex
-    }
-    glEnd();
+static void DrawStar(RenderBatch& target, float x, float y, float size) {
+    const Shape& star = GetShape(ShapeCollectibleStar);
+    BatchColor(target, 1.0f, 1.0f, 1.0f);  // White color for the star
+    BatchShape(target, GL_TRIANGLES, star.points, star.count, x, y, size);
 }
 
-//Function to draw a star(as a point or small polygon)
-static void DrawStar2(float x, float y, float size) {
-    glBegin(GL_POLYGON);
-    glColor3f(1.0f, 1.0f, 1.0f);  // White color for the star
-    for (int i = 0; i < 5; i++) {
-        float theta = 2.0f * M_PI * i / 5;
-        glVertex2f(x + size * cos(theta), y + size * sin(theta));
-    }
-    glEnd();
-}
-
-// Function to initialize stars
+// Function to initialize stars: picks a grid that holds about numStars stars.
+// Star positions are computed on the fly, so this allocates nothing.
 static void InitializeStars(int numStars) {
-    stars.clear();  // Clear any existing stars
-    for (int i = 0; i < numStars; i++) {
-        Star star;
-        star.x = ((rand() % 200) - 100) / 100.0f;  // Random X position between -1 and 1
-        star.y = ((rand() % 200) - 100) / 100.0f;  // Random Y position between -1 and 1
-        star.size = 0.005f * (rand() % 3 + 1);     // Random size (small to medium)
-        stars.push_back(star);                      // Add star to the vector
+    starfield.layers = 3;
+    starfield.rows = 4;
+    starfield.columns = numStars / (starfield.layers * starfield.rows);
+    if (starfield.columns < 1) {
+        starfield.columns = 1;
+    }
+    while (starfield.layers * starfield.rows * (starfield.columns + 1) > kMaxVisibleStars) {
+        starfield.columns--;
     }
+    starfield.parallax = false;
 }
 
-// Function to draw the background including stars
+// Function to draw the background including stars, all in a single draw call
 static void DrawBackground() {
-    for (const auto& star : stars) {
-        DrawStar2(star.x, star.y, star.size);
+    const GameWorld& world = shown->world;
+    starfield.seed = world.seed;  // Each round has its own sky, and a replayed round gets it back
+    // Interpolated distance so parallax scrolling is as smooth as the entities
+    float distance = world.distance - world.gameSpeed * (1.0f - renderAlpha);
+    int count = BuildStarfield(starfield, distance, visibleStars);
+
+    const Shape& pentagon = GetShape(ShapeSkyStar);
+    BatchColor(batch, 1.0f, 1.0f, 1.0f);  // White color for the stars
+    for (int i = 0; i < count; i++) {
+        const StarfieldStar& star = visibleStars[i];
+        BatchShape(batch, GL_POLYGON, pentagon.points, pentagon.count, star.x, star.y, star.size);
     }
 }
 
 // Function to draw an outer ring around the collectible
-static void DrawOuterRing(float x, float y, float size) {
-    glBegin(GL_LINE_LOOP);  // Draw as a line loop for the outer ring
-    glColor3f(1.0f, 0.8f, 0.0f);  // Slightly darker yellow for the ring
-    for (int i = 0; i < 20; i++) {
-        float theta = 2.0f * M_PI * float(i) / float(20);
-        float dx = (size + 0.02f) * cosf(theta);  // Slightly larger radius for the ring
-        float dy = (size + 0.02f) * sinf(theta);
-        glVertex2f(x + dx, y + dy);
-    }
-    glEnd();
+static void DrawOuterRing(RenderBatch& target, float x, float y, float size) {
+    const Shape& circle = GetShape(ShapeCollectibleDisc);
+    BatchColor(target, 1.0f, 0.8f, 0.0f);  // Slightly darker yellow for the ring
+    BatchShape(target, GL_LINE_LOOP, circle.points, circle.count, x, y, size + 0.02f);  // Slightly larger radius for the ring
 }
 
-// Function to draw the collectibles with enhanced visuals
-static void DrawCollectibles() {
-    for (const auto& collectible : collectibles) {
-        if (collectible.active) {
-            glPushMatrix();
-            glTranslatef(collectible.x, collectible.y, 0.0f);
-
-            // Apply pulsing effect (scaling the collectible)
-            glScalef(collectiblePulseScale, collectiblePulseScale, 1.0f);
+// Collectible with enhanced visuals, centred on the origin
+static void DrawCollectibleShape(RenderBatch& target, float size) {
+    // Draw the main collectible (yellow circle)
+    const Shape& circle = GetShape(ShapeCollectibleDisc);
+    BatchColor(target, 1.0f, 1.0f, 0.0f);  // Yellow color for the circle
+    BatchShape(target, GL_POLYGON, circle.points, circle.count, 0.0f, 0.0f, size);
 
-            // Draw the main collectible (yellow circle)
-            glColor3f(1.0f, 1.0f, 0.0f);  // Yellow color for the circle
-            glBegin(GL_POLYGON);
-            for (int i = 0; i < 20; i++) {
-                float theta = 2.0f * M_PI * float(i) / float(20);
-                float dx = collectible.size * cosf(theta);
-                float dy = collectible.size * sinf(theta);
-                glVertex2f(dx, dy);
-            }
-            glEnd();
+    // Draw an outer ring around the collectible
+    DrawOuterRing(target, 0.0f, 0.0f, size);
 
-            // Draw an outer ring around the collectible
-            DrawOuterRing(0.0f, 0.0f, collectible.size);
-
-            // Draw a star on top of the collectible
-            DrawStar(0.0f, 0.0f, collectible.size * 0.5f);  // Star size is half of the collectible size
+    // Draw a star on top of the collectible
+    DrawStar(target, 0.0f, 0.0f, size * 0.5f);  // Star size is half of the collectible size
+}
 
-            glPopMatrix();
+// Render extraction: an instance for every entity still in play, of the
+// mesh its kind's look picks
+static void DrawEntities() {
+    const AnimationState& animation = shown->animation;
+    float pulseScale = Interpolate(animation.prevCollectiblePulseScale, animation.collectiblePulseScale);
+    float rotationAngle = animation.powerUpRotationAngle;
+    if (rotationAngle < animation.prevPowerUpRotationAngle) {
+        rotationAngle += 360.0f;  // The angle wrapped during the last tick
+    }
+    rotationAngle = Interpolate(animation.prevPowerUpRotationAngle, rotationAngle);
+
+    const EntityStore& store = shown->world.entities;
+    for (int a = 0; a < store.archetypeCount; a++) {
+        const Archetype& archetype = store.archetypes[a];
+        const EntityLook& look = entityLooks[a];
+        const float* x = Column<ComponentX>(store, a);
+        const float* prevX = Column<ComponentPrevX>(store, a);
+        const float* y = Column<ComponentY>(store, a);
+        const bool* active = HasComponents(archetype, ComponentBit(ComponentActive)) ? Column<ComponentActive>(store, a) : NULL;
+        const unsigned char* meshBy = NULL;
+        if (look.meshBy == ComponentLane) {
+            meshBy = Column<ComponentLane>(store, a);
+        }
+        else if (look.meshBy == ComponentVariant) {
+            meshBy = Column<ComponentVariant>(store, a);
+        }
+        for (int i = 0; i < archetype.count; i++) {
+            int s = EntitySlot(archetype, i);
+            if (active != NULL && !active[s]) {
+                continue;  // Collected
+            }
+            int mesh = look.meshes[meshBy != NULL ? meshBy[s] : 0];
+            float scale = 1.0f;
+            float rotation = 0.0f;
+            if (look.animation == AnimatePulse) {
+                scale = pulseScale;
+            }
+            else if (look.animation == AnimateSpin) {
+                // Increase the scaling factor and rotate the power-up around its center
+                scale = Column<ComponentWidth>(store, a)[s] * 1.5f;
+                rotation = rotationAngle;
+            }
+            AddInstance(instancer, mesh, Interpolate(prevX[s], x[s]), y[s], scale, rotation);
         }
     }
 }
 
+// Record the entity shapes once; every entity is then drawn as an instance of one of them
+static void BuildEntityMeshes() {
+    RenderBatch scratch;
+    BatchReset(scratch);
+    EntityLook& obstacle = entityLooks[KindObstacle];
+    obstacle.meshBy = ComponentLane;
+    obstacle.animation = AnimateNone;
+    DrawObstacleShape(scratch, kObstacleWidth, kGroundObstacleHeight);
+    obstacle.meshes[LaneGround] = AddInstanceMesh(instancer, scratch);
+
+    BatchReset(scratch);
+    DrawObstacleShape(scratch, kObstacleWidth, kAboveObstacleHeight);
+    obstacle.meshes[LaneRaised] = AddInstanceMesh(instancer, scratch);
+
+    EntityLook& collectible = entityLooks[KindCollectible];
+    collectible.meshBy = kComponentCount;
+    collectible.animation = AnimatePulse;
+    BatchReset(scratch);
+    DrawCollectibleShape(scratch, kCollectibleSize);
+    collectible.meshes[0] = AddInstanceMesh(instancer, scratch);
+
+    EntityLook& powerUp = entityLooks[KindPowerUp];
+    powerUp.meshBy = ComponentVariant;
+    powerUp.animation = AnimateSpin;
+    BatchReset(scratch);
+    DrawPowerUpShape(scratch, 1);
+    powerUp.meshes[1] = AddInstanceMesh(instancer, scratch);
+
+    BatchReset(scratch);
+    DrawPowerUpShape(scratch, 2);
+    powerUp.meshes[2] = AddInstanceMesh(instancer, scratch);
+}
+
 // Function to draw a simple asteroid (using a polygon)
 static void DrawAsteroid(float x, float y, float size) {
-    glBegin(GL_POLYGON);
-    glColor3f(0.5f, 0.5f, 0.5f);  // Gray color for the asteroid
-    for (int i = 0; i < 7; i++) {
-        float theta = 2.0f * M_PI * i / 7;
-        glVertex2f(x + size * cos(theta), y + size * sin(theta));
-    }
-    glEnd();
+    const Shape& asteroid = GetShape(ShapeAsteroid);
+    BatchColor(batch, 0.5f, 0.5f, 0.5f);  // Gray color for the asteroid
+    BatchShape(batch, GL_POLYGON, asteroid.points, asteroid.count, x, y, size);
 }
 
 // Function to draw upper and lower boundaries with space objects
@@ -493,32 +543,23 @@ static void DrawBoundaries() {
     }
 }
 
-// Function to draw a glowing moon
-static void DrawMoon(float x, float y, float size) {
-    glPushMatrix();
-    glTranslatef(x, y, 0.0f);
-    glRotatef(gameTime * 10, 0.0f, 0.0f, 1.0f);  // Rotate the moon slowly over time
+// Function to draw a glowing moon, turned by angle degrees
+static void DrawMoon(float x, float y, float size, float angle) {
+    BatchPushMatrix(batch);
+    BatchTranslate(batch, x, y);
+    BatchRotate(batch, angle);
 
     // Draw the main body of the moon (gray color)
-    glBegin(GL_POLYGON);
-    glColor3f(0.8f, 0.8f, 0.8f);  // Light gray color for the moon
-    for (int i = 0; i < 30; i++) {
-        float theta = 2.0f * M_PI * i / 30;
-        glVertex2f(size * cos(theta), size * sin(theta));
-    }
-    glEnd();
+    const Shape& disc = GetShape(ShapeMoonDisc);
+    BatchColor(batch, 0.8f, 0.8f, 0.8f);  // Light gray color for the moon
+    BatchShape(batch, GL_POLYGON, disc.points, disc.count, 0.0f, 0.0f, size);
 
     // Draw a glowing effect around the moon
-    glBegin(GL_TRIANGLE_FAN);
-    glColor4f(1.0f, 1.0f, 0.8f, 0.4f);  // Semi-transparent light yellow color for glow
-    glVertex2f(0.0f, 0.0f);  // Center point
-    for (int i = 0; i <= 30; i++) {
-        float theta = 2.0f * M_PI * i / 30;
-        glVertex2f(size * 1.5f * cos(theta), size * 1.5f * sin(theta));  // Slightly larger than the moon
-    }
-    glEnd();
+    const Shape& glow = GetShape(ShapeMoonGlow);
+    BatchColor(batch, 1.0f, 1.0f, 0.8f, 0.4f);  // Semi-transparent light yellow color for glow
+    BatchShape(batch, GL_TRIANGLE_FAN, glow.points, glow.count, 0.0f, 0.0f, size * 1.5f);  // Slightly larger than the moon
 
-    glPopMatrix();
+    BatchPopMatrix(batch);
 }
 
 // Function to render bitmap text
@@ -529,505 +570,750 @@ void renderBitmapString(float x, float y, void* font, const char* string) {
     }
 }
 
-// Function to handle game end screen
-static void DisplayGameEnd(const char* message) {
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    // Background color for the end screen
-    glColor3f(0.0f, 0.0f, 0.0f);  // Full black background
-    glBegin(GL_QUADS);
-    glVertex2f(-1.0f, -1.0f);
-    glVertex2f(1.0f, -1.0f);
-    glVertex2f(1.0f, 1.0f);
-    glVertex2f(-1.0f, 1.0f);
-    glEnd();
-
-    // Center the text horizontally and vertically
-    glColor3f(0.8f, 0.0f, 0.0f);  // Dark, blood-red color for the text
-    renderBitmapString(-0.16f, 0.2f, GLUT_BITMAP_TIMES_ROMAN_24, message);  // Game End or Lose message
-
-    // Display the score in a slightly smaller font, also centered
-    glColor3f(0.9f, 0.9f, 0.9f);  // White color for score text
-    char scoreMessage[50];
-    sprintf(scoreMessage, "Your final score is: %d", score);
-    renderBitmapString(-0.23f, 0.0f, GLUT_BITMAP_HELVETICA_18, scoreMessage);
-
-    // Add a decorative border
-    glColor3f(1.0f, 1.0f, 1.0f);  // White border
-    glBegin(GL_LINE_LOOP);
-    glVertex2f(-0.6f, -0.4f);
-    glVertex2f(0.6f, -0.4f);
-    glVertex2f(0.6f, 0.6f);
-    glVertex2f(-0.6f, 0.6f);
-    glEnd();
-
-    glFlush();
-    glutSwapBuffers();
+// Rotation of the moon in degrees: 10 for every second on the countdown, so
+// it changes, and the moon layer is drawn again, once a second
+static int MoonAngle(const GameWorld& world) {
+    return world.gameTime * 10;
 }
 
-// Update background animations
-static void UpdateBackgroundAnimations() {
+// Draw the moon and other space objects, which move with the game time
+static void DrawSpaceObjects() {
     // Draw stars (if applicable, you can call your star drawing function here)
 
     // Add planets and other space objects that slightly move or rotate
-    DrawMoon(-0.7f, 0.5f, 0.1f);  // Example of adding a moon
+    DrawMoon(-0.7f, 0.5f, 0.1f, (float)MoonAngle(shown->world));  // Example of adding a moon
 
     // You can add more moons or space objects if needed
 }
 
 static void UpdateAnimations() {
+    AnimationState& animation = simAnimation;
+    animation.prevPowerUpRotationAngle = animation.powerUpRotationAngle;
+    animation.prevCollectiblePulseScale = animation.collectiblePulseScale;
+
     // Rotate power-ups
-    powerUpRotationAngle += 1.0f + (gameSpeed * 0.1f);  // Increase rotation based on game speed
-    if (powerUpRotationAngle >= 360.0f) {
-        powerUpRotationAngle = 0.0f;  // Reset to avoid overflow
+    animation.powerUpRotationAngle += 1.0f + (simWorld.gameSpeed * 0.1f);  // Increase rotation based on game speed
+    if (animation.powerUpRotationAngle >= 360.0f) {
+        animation.powerUpRotationAngle = 0.0f;  // Reset to avoid overflow
     }
 
     // Pulse effect for collectibles (scale up and down)
-    if (increasingScale) {
-        collectiblePulseScale += 0.01f + (gameSpeed * 0.001f);  // Increase scale based on speed
-        if (collectiblePulseScale >= 1.2f) {
-            increasingScale = false;  // Start decreasing when max scale is reached
+    if (animation.increasingScale) {
+        animation.collectiblePulseScale += 0.01f + (simWorld.gameSpeed * 0.001f);  // Increase scale based on speed
+        if (animation.collectiblePulseScale >= 1.2f) {
+            animation.increasingScale = false;  // Start decreasing when max scale is reached
         }
     }
     else {
-        collectiblePulseScale -= 0.01f + (gameSpeed * 0.001f);  // Decrease scale based on speed
-        if (collectiblePulseScale <= 0.8f) {
-            increasingScale = true;  // Start increasing again when min scale is reached
+        animation.collectiblePulseScale -= 0.01f + (simWorld.gameSpeed * 0.001f);  // Decrease scale based on speed
+        if (animation.collectiblePulseScale <= 0.8f) {
+            animation.increasingScale = true;  // Start increasing again when min scale is reached
         }
     }
 }
 
-static void MoveCollectibles() {
-    for (auto& collectible : collectibles) {
-        if (collectible.active) {
-            collectible.x -= gameSpeed;
+// Function to draw the game frame (upper and lower borders)
+static void DrawGameFrame() {
+    BatchPushMatrix(batch);
+    BatchColor(batch, 0.0f, 0.0f, 0.0f);  // Black color
 
-            // Deactivate or reset collectible if it goes off-screen
-            if (collectible.x < -1.0f) {
-                collectible.active = false;  // Deactivate the collectible
-            }
-        }
-    }
+    BatchBegin(batch, GL_QUADS);
+    BatchVertex2f(batch, -1.0f, 0.9f);  // Left side
+    BatchVertex2f(batch, 1.0f, 0.9f);   // Right side
+    BatchVertex2f(batch, 1.0f, 1.0f);   // Top right corner
+    BatchVertex2f(batch, -1.0f, 1.0f);  // Top left corner
+    BatchEnd(batch);
+
+
+    // Lower Border (using quads)
+    BatchBegin(batch, GL_QUADS);
+    BatchVertex2f(batch, -1.0f, -1.0f);  // Bottom left corner
+    BatchVertex2f(batch, 1.0f, -1.0f);   // Bottom right corner
+    BatchVertex2f(batch, 1.0f, -0.9f);    // Just above the bottom
+    BatchVertex2f(batch, -1.0f, -0.9f);   // Just above the bottom
+    BatchEnd(batch);
+
+    BatchPopMatrix(batch);
 }
 
-static void MovePowerUps() {
-    for (auto& powerUp : powerUps) {
-        if (powerUp.active) {
-            powerUp.x -= gameSpeed;  // Move power-up downwards
-            if (powerUp.x < -1.0f) {
-                powerUp.active = false;  // Deactivate if it goes off-screen
-            }
-        }
-    }
+// Function to draw the ground
+static void DrawGround() {
+    BatchPushMatrix(batch);
+    BatchColor(batch, 0.5f, 0.35f, 0.05f);  // Brownish color for the ground
+    BatchBegin(batch, GL_QUADS);
+    BatchVertex2f(batch, -1.0f, -0.9f);  // Ground above the lower border
+    BatchVertex2f(batch, -1.0f, -0.7f);
+    BatchVertex2f(batch, 1.0f, -0.7f);
+    BatchVertex2f(batch, 1.0f, -0.9f);
+    BatchEnd(batch);
+    BatchPopMatrix(batch);
 }
 
-static void SpawnCollectibles() {
-    if (rand() % 80 == 0) {  // Randomize the spawning frequency
-        Collectible newCollectible;
-        newCollectible.x = 1.0f;  // Start at the right edge of the screen
+// Register the fonts; the atlas itself is baked by the first Display
+static void InitializeText() {
+    InitGlyphAtlas(glyphAtlas);
+    hudFont = AddAtlasFont(glyphAtlas, GLUT_BITMAP_HELVETICA_18, 24, 6);
+    titleFont = AddAtlasFont(glyphAtlas, GLUT_BITMAP_TIMES_ROMAN_24, 30, 8);
+    InitTextLabel(scoreLabel);
+    InitTextLabel(timeLabel);
+    InitTextLabel(endScreenLabel);
+    InitTextLabel(profilerLabel);
+}
 
-        // Randomly decide whether to spawn on the ground or in the air
-        if (rand() % 2 == 0) {
-            newCollectible.y = -0.6f;  // Ground level
+// Profiler overlay: p50 / p95 / p99 per phase over the last kProfileFrames
+// frames (ticks for Simulate and Events), the same for the input-to-present
+// latency of the last kLatencySamples inputs, a graph of the frame times and
+// the heap allocations of those frames and ticks, which stay at zero once the
+// round has warmed up. The text is refreshed twice a second.
+static void DrawProfilerOverlay() {
+    if (!profiler.overlayVisible) {
+        return;
+    }
+    const float left = -0.98f, right = -0.1f, bottom = -0.12f, top = 0.88f;
+    const float graphBottom = 0.0f, graphHeight = 0.25f;
+    const float graphMs = 33.3f;  // Frame time at the top of the graph
+
+    BatchReset(batch);
+    BatchColor(batch, 0.0f, 0.0f, 0.0f);  // Backing panel
+    BatchBegin(batch, GL_QUADS);
+    BatchVertex2f(batch, left, bottom);
+    BatchVertex2f(batch, right, bottom);
+    BatchVertex2f(batch, right, top);
+    BatchVertex2f(batch, left, top);
+    BatchEnd(batch);
+
+    // One bar per frame, newest on the right: green within 60 Hz, yellow within 30 Hz, red beyond
+    int frames = ProfiledFrameCount(profiler);
+    float barSpacing = (right - left - 0.04f) / kProfileFrames;
+    BatchBegin(batch, GL_LINES);
+    for (int age = 0; age < frames; age++) {
+        ProfileFrame recent;
+        if (!ReadProfileFrame(profiler, age, recent)) {
+            continue;
+        }
+        float ms = recent.frameMs;
+        float x = right - 0.02f - age * barSpacing;
+        float height = (ms < graphMs ? ms : graphMs) / graphMs * graphHeight;
+        if (ms <= 1000.0f / 60.0f) {
+            BatchColor(batch, 0.2f, 0.9f, 0.2f);
+        }
+        else if (ms <= 1000.0f / 30.0f) {
+            BatchColor(batch, 0.9f, 0.9f, 0.2f);
         }
         else {
-            newCollectible.y = 0.5f; // High in the air
+            BatchColor(batch, 0.9f, 0.2f, 0.2f);
         }
-
-        newCollectible.size = 0.05f;  // Default size
-        newCollectible.active = true;
-
-        collectibles.push_back(newCollectible);  // Add the collectible to the vector
+        BatchVertex2f(batch, x, graphBottom);
+        BatchVertex2f(batch, x, graphBottom + height);
     }
-}
+    BatchColor(batch, 1.0f, 1.0f, 1.0f);  // 60 Hz budget
+    float budgetY = graphBottom + (1000.0f / 60.0f) / graphMs * graphHeight;
+    BatchVertex2f(batch, left + 0.02f, budgetY);
+    BatchVertex2f(batch, right - 0.02f, budgetY);
+    BatchEnd(batch);
+    BatchFlush(batch);
+
+    int refresh = (int)(profiler.frameCount.load(std::memory_order_relaxed) / 30);
+    if (!TextLabelIsCurrent(profilerLabel, glyphAtlas, refresh)) {
+        ProfileStats phases[PhaseCount];
+        ProfileStats frame;
+        ComputeProfileStats(profiler, phases, frame);
+        ProfileStats tickPhases[PhaseCount];
+        ProfileStats tick;
+        ComputeProfileStats(tickProfiler, tickPhases, tick);  // Written by the simulation thread, see ProfileSlot
+        phases[PhaseSimulate] = tickPhases[PhaseSimulate];
+        phases[PhaseEvents] = tickPhases[PhaseEvents];
+        ProfileStats input;
+        ComputeInputLatencyStats(inputLatency, input);
+
+        ResetTextLabel(profilerLabel, glyphAtlas, refresh);
+        const float columns[] = { -0.96f, -0.62f, -0.44f, -0.26f };
+        const char* headers[] = { "ms", "p50", "p95", "p99" };
+        float y = top - 0.08f;
+        for (int c = 0; c < 4; c++) {
+            AppendText(profilerLabel, glyphAtlas, hudFont, headers[c], columns[c], y, 1.0f, 1.0f, 0.0f);
+        }
+        for (int row = 0; row <= PhaseCount + 1; row++) {  // Phases, then the frame and the input latency
+            const ProfileStats& stats = row < PhaseCount ? phases[row] : row == PhaseCount ? frame : input;
+            const char* name = row < PhaseCount ? ProfilePhaseName((ProfilePhase)row) : row == PhaseCount ? "Frame" : "Input";
+            float values[] = { stats.p50, stats.p95, stats.p99 };
+            y -= 0.06f;
+            AppendText(profilerLabel, glyphAtlas, hudFont, name, columns[0], y, 1.0f, 1.0f, 1.0f);
+            for (int c = 0; c < 3; c++) {
+                char text[16];
+                sprintf(text, "%.2f", values[c]);
+                AppendText(profilerLabel, glyphAtlas, hudFont, text, columns[c + 1], y, 1.0f, 1.0f, 1.0f);
+            }
+        }
 
-// Function to spawn obstacles and collectables randomly with spacing
-static void SpawnObstacles() {
-    // Ensure a minimum distance between consecutive obstacles
-    if (!obstacles.empty() && obstacles.back().x > 0.5f) {
-        return;  // If the last obstacle is too close, skip spawning
+        int framesAllocating, ticksAllocating;
+        int frameAllocations = CountProfiledAllocations(profiler, framesAllocating);
+        int tickAllocations = CountProfiledAllocations(tickProfiler, ticksAllocating);
+        char text[64];
+        sprintf(text, "Allocations: %d in %d frames, %d in %d ticks", frameAllocations, framesAllocating, tickAllocations, ticksAllocating);
+        bool allocating = frameAllocations > 0 || tickAllocations > 0;
+        AppendText(profilerLabel, glyphAtlas, hudFont, text, columns[0], graphBottom - 0.07f, 1.0f, allocating ? 0.3f : 1.0f, allocating ? 0.3f : 1.0f);
     }
+    DrawTextLabel(glyphAtlas, profilerLabel);
+}
 
-    Obstacle obs;
-    obs.x = 1.0f;  // Spawn at the right edge of the screen
+static void DrawScene();
 
-    // Randomly set obstacle height to either ground level or slightly above the player
-    if (rand() % 3 == 0) {
-        obs.y = -0.7f;  // Ground level (obstacle sits above the grass but aligned with the player)
-        obs.height = 0.2f;  // Small obstacle on the ground (for jumping over)
-    }
-    else {
-        obs.y = -0.5f;  // Positioned slightly above the player (requires ducking)
-        obs.height = 0.25f;  // Taller obstacle (for ducking under)
+// Emit the bursts the ticks asked for and move the particles on by seconds
+static void AdvanceParticles(float seconds) {
+    ProfileScope scope(profiler, PhaseParticles);
+    ParticleBurst burst;
+    while (particleBursts.pop(burst)) {
+        EmitParticles(particles, burst);
     }
-
-    obs.width = 0.1f;  // Fixed width
-
-    obstacles.push_back(obs);
+    UpdateParticles(particles, seconds);
 }
 
-static void SpawnPowerUps() {
-    if (rand() % 180 == 0) {  // Randomize the spawning frequency
-        PowerUp newPowerUp;
-        newPowerUp.x = 1.0f;  // Start at the right edge of the screen
-        if (rand() % 2 == 0) {
-            newPowerUp.y = -0.6f;  // Ground level
+// Draw everything behind the entities. The scenery and the moon come from
+// the layer cache, so most frames draw them as two quads; the ground is
+// drawn before the moon there, which changes nothing as they do not overlap.
+// Scrolling stars (parallax) change every frame and are drawn directly.
+static void DrawBackgroundLayers() {
+    if (LayerCacheAvailable() && !starfield.parallax) {
+        const GameWorld& world = shown->world;
+        if (BeginLayerRender(sceneryLayer, world.seed)) {
+            glClear(GL_COLOR_BUFFER_BIT);
+            DrawGameFrame();
+            DrawBackground();
+            DrawBoundaries();
+            DrawGround();
+            BatchFlush(batch);
+            BatchReset(batch);
+            EndLayerRender(sceneryLayer);
         }
-        else {
-            newPowerUp.y = 0.5f; // High in the air
+        unsigned long long moonKey = (unsigned long long)sceneryLayer.renders << 32 | (unsigned int)MoonAngle(world);
+        if (BeginLayerRender(moonLayer, moonKey)) {
+            DrawCachedLayer(sceneryLayer);
+            DrawSpaceObjects();
+            BatchFlush(batch);
+            BatchReset(batch);
+            EndLayerRender(moonLayer);
         }
-        newPowerUp.size = 0.05f;  // Default size
-        newPowerUp.active = true;
+        if (sceneryLayer.valid && moonLayer.valid) {
+            DrawCachedLayer(sceneryLayer);
+            DrawCachedLayer(moonLayer);
+            return;
+        }
+    }
+    DrawGameFrame();
+    DrawBackground();
+    DrawBoundaries();
+    DrawSpaceObjects();
+    DrawGround();
+}
 
-        // Randomly assign a type (1 for magnet, 2 for invincibility)
-        newPowerUp.type = (rand() % 2) + 1;  // Either 1 or 2
-        powerUps.push_back(newPowerUp);  // Add the power-up to the vector
+// Draw the running game: scene, HUD and the profiler overlay
+static void DrawScene() {
+    // Draw the game frame, health bar, player, and obstacles into the batch
+    BatchReset(batch);
+    InstanceReset(instancer);
+    {
+        ProfileScope scope(profiler, PhaseBackground);
+        DrawBackgroundLayers();
+    }
+    {
+        ProfileScope scope(profiler, PhaseScene);
+        DrawHealthBar();
+        DrawPlayer();
+        DrawEntities();  // Obstacles, collectibles and power-ups
+    }
+    {
+        ProfileScope scope(profiler, PhaseSubmit);
+        BatchFlush(batch);  // One upload, one draw call per primitive type
+        InstanceFlush(instancer, batch);  // Entities on top, one instanced draw call per mesh
     }
+    {
+        ProfileScope scope(profiler, PhaseParticles);
+        DrawParticles(particles);  // Effects on top of everything but the text
+    }
+    {
+        ProfileScope scope(profiler, PhaseText);
+        DrawScoreAndTime();  // Bitmap text is drawn on top of the scene
+    }
+    DrawProfilerOverlay();
 }
 
-// Function to move obstacles toward the player and remove them when off-screen
-static void MoveObstacles() {
-    for (auto it = obstacles.begin(); it != obstacles.end();) {
-        it->x -= gameSpeed;  // Move obstacle to the left
+// Ask the GLUT thread for a burst of particles. Moves with the world, so
+// the effect stays where it happened. Dropped if the frames are far behind.
+static void QueueParticles(ParticleEffect effect, float x, float y, int variant) {
+    ParticleBurst burst = { effect, x, y, -simWorld.gameSpeed * kTicksPerSecond, variant };
+    particleBursts.push(burst);
+}
 
-        // Remove obstacles that go off-screen
-        if (it->x < -1.0f) {
-            it = obstacles.erase(it);
-        }
-        else {
-            ++it;
+// Sounds, log lines and particle effects for what the collision functions reported
+static void HandleWorldEvents() {
+    for (int i = 0; i < simWorld.eventCount; i++) {
+        const GameEvent& event = simWorld.events[i];
+        switch (event.type) {
+        case EventCollectedWithMagnet:
+            PlaySoundEffect(audio, SoundCoin);  // Play collect sound effect
+            QueueParticles(EffectPickup, event.x, event.y, 0);
+            LOG_INFO("Automatically collected collectible with Magnet! Score: %d", simWorld.score);
+            break;
+        case EventCollectedGround:
+            PlaySoundEffect(audio, SoundCoin);  // Play collect sound effect
+            QueueParticles(EffectPickup, event.x, event.y, 0);
+            LOG_INFO("Collected ground collectible! Score: %d", simWorld.score);
+            break;
+        case EventCollectedHigh:
+            PlaySoundEffect(audio, SoundCoin);  // Play collect sound effect
+            QueueParticles(EffectPickup, event.x, event.y, 0);
+            LOG_INFO("Collected high collectible! Score: %d", simWorld.score);
+            break;
+        case EventMagnetCollected:
+            PlaySoundEffect(audio, SoundMagnet);  // Play collect sound effect
+            QueueParticles(EffectPowerUp, event.x, event.y, 1);
+            LOG_INFO("Collected Magnet Power-Up!");
+            break;
+        case EventInvincibilityCollected:
+            PlaySoundEffect(audio, SoundInvincible);  // Play collect sound effect
+            QueueParticles(EffectPowerUp, event.x, event.y, 2);
+            LOG_INFO("Collected Invincibility Power-Up!");
+            break;
+        case EventPowerUpMissed:
+            LOG_DEBUG("Not collected high collectible: playerY = %.2f, collectible.y = %.2f", simWorld.playerY, event.y);
+            break;
+        case EventHitGroundObstacle:
+            PlaySoundEffect(audio, SoundObstacle);  // Play hit sound effect
+            QueueParticles(EffectHit, event.x + kObstacleWidth * 0.5f, event.y + kGroundObstacleHeight * 0.5f, 0);
+            QueueParticles(EffectKnockback, simWorld.playerX - 0.1f, simWorld.playerY - 0.7f, 0);  // At the player's feet
+            LOG_INFO("Hit ground obstacle! Lives remaining: %d", simWorld.lives);
+            break;
+        case EventHitAboveObstacle:
+            PlaySoundEffect(audio, SoundObstacle);  // Play hit sound effect
+            QueueParticles(EffectHit, event.x + kObstacleWidth * 0.5f, event.y + kAboveObstacleHeight * 0.5f, 0);
+            QueueParticles(EffectKnockback, simWorld.playerX - 0.1f, simWorld.playerY - 0.7f, 0);
+            LOG_INFO("Hit above obstacle! Lives remaining: %d", simWorld.lives);
+            break;
+        case EventMagnetExpired:
+            LOG_INFO("Magnet Power-Up deactivated.");
+            break;
+        case EventInvincibilityExpired:
+            LOG_INFO("Invincibility Power-Up deactivated.");
+            break;
+        default:
+            break;
         }
     }
 }
 
-// Function to handle jumping mechanics with speed adjustments
-static void JumpMechanics() {
-    if (isJumping) {
-        playerY += jumpVelocity * gameSpeed * 100;  // Move the player upwards faster as gameSpeed increases
-        jumpVelocity -= gravity * gameSpeed * 50;   // Apply stronger gravity over time
-
-        // Check if the player lands back on the ground
-        if (playerY <= 0.0f) {  // Player has landed back
-            playerY = 0.0f;      // Reset to ground level (relative to -0.7f in DrawPlayer)
-            isJumping = false;   // Stop jumping
-            jumpVelocity = 0.05f; // Reset jump velocity
+// Advance everything that runs at the fixed simulation rate by one tick
+static void RunTick() {
+    long long allocationsBefore = ThreadAllocationCount();
+    {
+        ProfileScope scope(tickProfiler, PhaseSimulate);
+        TickInput input = DrainInput(inputQueue);  // Keys pressed during playback are dropped here
+        if (replaying) {
+            input = ReplayInput(playback, replayTick++);
+        }
+        if (demo) {
+            input = PlanLookaheadInput(simWorld);
         }
+        if (recordPath != NULL) {
+            RecordReplayTick(recording, input);
+        }
+        StepGameWorld(simWorld, input);  // Move, collide, spawn and expire power-ups
+    }
+    {
+        ProfileScope scope(tickProfiler, PhaseEvents);
+        HandleWorldEvents();
+        UpdateAnimations();
     }
+    tickProfiler.pendingAllocations = (int)(ThreadAllocationCount() - allocationsBefore);
+    EndProfileFrame(tickProfiler);
 }
 
-// Function to handle key presses
-static void KeyPress(unsigned char key, int x, int y) {
-    if (key == ' ' && !isJumping) {  // Space for jump
-        isJumping = true;
-    }
-    if (key == 'd') {  // 'd' for duck, allow ducking in the air
-        isDucking = true;
-    }
+// Reset the world for a round with the given seed, with its level laid out ahead
+static void StartRound(unsigned int seed) {
+    StopChunkFeed(chunkFeed);
+    InitGameWorld(simWorld, seed);
+    StartChunkFeed(chunkFeed, simWorld);
 }
 
-// Function to handle collectible collisions
-static void CheckCollectibleCollisions() {
-    for (auto& collectible : collectibles) {
-        if (collectible.active && -0.8f < collectible.x + collectible.size && -0.8f + 0.1f > collectible.x) {
-            if (hasMagnet) {
-                score += 500;
-                collectible.active = false;
-                //playSoundEffect("C:\\Users\\DELL\\Desktop\\OpenGL2DTemplate\\coin.wav");  // Play collect sound effect
-                printf("Automatically collected collectible with Magnet! Score: %d\n", score);
-                continue;
-            }
-            if (collectible.y == -0.6f && playerY <= 0.1f) {
-                score += 500;
-                collectible.active = false;
-                //playSoundEffect("C:\\Users\\DELL\\Desktop\\OpenGL2DTemplate\\coin.wav");  // Play collect sound effect
-                printf("Collected ground collectible! Score: %d\n", score);
-            }
-            else if (playerY >= collectible.y + 0.5f) {
-                score += 500;
-                collectible.active = false;
-                //playSoundEffect("C:\\Users\\DELL\\Desktop\\OpenGL2DTemplate\\coin.wav");  // Play collect sound effect
-                printf("Collected high collectible! Score: %d\n", score);
-            }
-        }
+// Hand the state after the last tick over to the GLUT thread
+static void PublishSnapshot() {
+    WorldSnapshot& snapshot = snapshots.writeSlot();
+    snapshot.world = simWorld;
+    snapshot.world.chunkFeed = NULL;  // The copy must never take chunks meant for the live world
+    snapshot.animation = simAnimation;
+    snapshot.input = inputQueue.newest;
+    snapshot.tickTime = FixedTimestepTickTime(timestep);
+    snapshot.tickSeconds = timestep.tickSeconds;
+    snapshots.publish();
+}
+
+static void ShutdownChunkFeed() {
+    ShutdownChunkFeed(chunkFeed);
+}
+
+void InitializeGame(bool hudText) {
+    glClearColor(0.1f, 0.1f, 0.3f, 1.0f);  // Dark blue background
+    gluOrtho2D(-1.0, 1.0, -1.0, 1.0);  // Set the coordinate system
+    LoadGLExtensions();
+    InitShapeCache(DefaultShapeDetail());
+    InitRenderBatch(batch);
+    InitInstanceRenderer(instancer);
+    InitCachedLayer(sceneryLayer, -1.0f, -1.0f, 1.0f, 1.0f);
+    InitCachedLayer(moonLayer, -0.86f, 0.34f, -0.54f, 0.66f);  // Around the moon's glow (see DrawSpaceObjects)
+    BuildEntityMeshes();
+    InitParticleSystem(particles);
+    lastParticleUpdate = std::chrono::steady_clock::now();
+    InitializeText();
+    hudTextEnabled = hudText;
+    glyphAtlas.bakeAttempted = !hudText;  // Baking the atlas draws with GLUT's fonts too
+    int tickRate = (int)(kTicksPerSecond * timeScale + 0.5);  // Playback at another speed only changes the tick rate
+    InitFixedTimestep(timestep, tickRate > 0 ? tickRate : 1);
+    InitProfiler(profiler);
+    InitProfiler(tickProfiler);
+    InitializeStars(72);  // About as many stars as the old sky collected in a round
+    InitChunkFeed(chunkFeed);
+    atexit(ShutdownChunkFeed);  // A running std::thread may not be destroyed
+    InitInputQueue(inputQueue);
+    InitInputLatency(inputLatency);
+}
+
+void RestartGame(unsigned int seed) {
+    StartRound(seed);
+    InitInputQueue(inputQueue);
+    replayTick = 0;
+    if (recordPath != NULL) {
+        BeginReplay(recording, seed);
     }
+    PublishSnapshot();  // The first frame shows the new round
 }
 
-static void CheckPowerUpCollisions() {
-    for (auto& powerUp : powerUps) {
-        // Check if power-up is active and within the horizontal bounds of the player
-        if (powerUp.active && -0.8f < powerUp.x + powerUp.size && -0.8f + 0.1f > powerUp.x) {
-            // Check if the player is on the ground or within a certain jumping height
-            if (powerUp.y == -0.6f) {  // Assuming playerY = 0 is ground level
-                if (playerY <= 0.1f) {
-                    // Collect the power-up if the player is on the ground and aligned with it
-                    if (powerUp.type == 1) {
-                        hasMagnet = true;  // Activate magnet
-                        powerUpStartTime = clock();  // Track time when acquired
-                        //playSoundEffect("C:\\Users\\DELL\\Desktop\\OpenGL2DTemplate\\Magnet.wav");  // Play collect sound effect
-                        printf("Collected Magnet Power-Up!\n");
-                    }
-                    else {
-                        isInvincible = true;  // Activate invincibility
-                        powerUpStartTime = clock();  // Track time   when acquired
-                        //playSoundEffect("C:\\Users\\DELL\\Desktop\\OpenGL2DTemplate\\invincible.wav");  // Play collect sound effect
-                        printf("Collected Invincibility Power-Up!\n");
-                    }
-                    powerUp.active = false;  // Deactivate power-up after it's collected
-                }
-            }
-            else {
-                // If the player is jumping, check if they are above the power-up and within range
-                if (playerY >= powerUp.y + 0.5f) {
-                    // Collect the power-up if the player is above it
-                    if (powerUp.type == 1) {
-                        hasMagnet = true;  // Activate magnet
-                        powerUpStartTime = clock();  // Track time when acquired
-                        //playSoundEffect("C:\\Users\\DELL\\Desktop\\OpenGL2DTemplate\\Magnet.wav");  // Play collect sound effect
-                        printf("Collected Magnet Power-Up!\n");
-                    }
-                    else {
-                        isInvincible = true;  // Activate invincibility
-                        powerUpStartTime = clock();  // Track time when acquired
-                        //playSoundEffect("C:\\Users\\DELL\\Desktop\\OpenGL2DTemplate\\invincible.wav");  // Play collect sound effect
-                        printf("Collected Invincibility Power-Up!\n");
-                    }
-                    powerUp.active = false;  // Deactivate power-up after it's collected
-                }
-                else {
-                    // Debug information
-                    printf("Not collected high collectible: playerY = %.2f, collectible.y = %.2f\n", playerY, powerUp.y);
-                }
-            }
-        }
+bool StartReplay(const char* path) {
+    if (!LoadReplay(playback, path)) {
+        return false;
     }
+    replaying = true;
+    RestartGame(playback.seed);
+    return true;
 }
 
-// Function to handle collisions
-static void CheckCollisions() {
-    for (auto& obstacle : obstacles) {
-        if (-0.8f < obstacle.x + obstacle.width && -0.8f + 0.1f > obstacle.x) {
-            if (!obstacle.hasHitPlayer) {
-                if (obstacle.y == -0.7f && playerY <= 0.0f && !isInvincible) {
-                    isKnockedBack = true;
-                    knockbackTimer = knockbackDuration;
-                    playerX -= knockbackStrength;
-                    lives--;
-                    //playSoundEffect("C:\\Users\\DELL\\Desktop\\OpenGL2DTemplate\\obstacle.wav");  // Play hit sound effect
-                    printf("Hit ground obstacle! Lives remaining: %d\n", lives);
-                    obstacle.hasHitPlayer = true;
-                    if (lives == 0) {
-                        gameLose = true;  // Set game over flag
-                    }
-                }
-                else if (!isDucking && playerY <= obstacle.height && !isInvincible) {
-                    isKnockedBack = true;
-                    knockbackTimer = knockbackDuration;
-                    playerX -= knockbackStrength;
-                    lives--;
-                    //playSoundEffect("C:\\Users\\DELL\\Desktop\\OpenGL2DTemplate\\obstacle.wav");  // Play hit sound effect
-                    printf("Hit above obstacle! Lives remaining: %d\n", lives);
-                    obstacle.hasHitPlayer = true;
-                    if (lives == 0) {
-                        gameLose = true;  // Set game over flag
-                    }
-                }
-            }
-        }
-        if (obstacle.x + obstacle.width < -0.8f) {
-            obstacle.hasHitPlayer = false;
+void RunGameTicks(int ticks) {
+    for (int i = 0; i < ticks; i++) {
+        if (simWorld.gameEnd || simWorld.gameLose) {
+            RestartGame(replaying ? playback.seed : simWorld.seed + 1);  // Keep playing instead of showing the end screen
         }
+        RunTick();
     }
+    PublishSnapshot();
 }
 
-// Function to draw the game frame (upper and lower borders)
-static void DrawGameFrame() {
-    glPushMatrix();
-    glColor3f(0.0f, 0.0f, 0.0f);  // Black color
-
-    glBegin(GL_QUADS);
-    glVertex2f(-1.0f, 0.9f);  // Left side
-    glVertex2f(1.0f, 0.9f);   // Right side
-    glVertex2f(1.0f, 1.0f);   // Top right corner
-    glVertex2f(-1.0f, 1.0f);  // Top left corner
-    glEnd();
+void RenderGameFrame() {
+    long long allocationsBefore = ThreadAllocationCount();
+    shown = &snapshots.read();
+    renderAlpha = 1.0f;  // Frames are driven by the caller, not by real time
+    AdvanceParticles(1.0f / kTicksPerSecond);
+    glClear(GL_COLOR_BUFFER_BIT);
+    DrawScene();
+    profiler.pendingAllocations = (int)(ThreadAllocationCount() - allocationsBefore);
+    EndProfileFrame(profiler);
+}
 
+#ifndef QUICKRUNNER_NO_MAIN
 
-    // Lower Border (using quads)
-    glBegin(GL_QUADS);
-    glVertex2f(-1.0f, -1.0f);  // Bottom left corner
-    glVertex2f(1.0f, -1.0f);   // Bottom right corner
-    glVertex2f(1.0f, -0.9f);    // Just above the bottom
-    glVertex2f(-1.0f, -0.9f);   // Just above the bottom
-    glEnd();
-
-    glPopMatrix();
-}
+// The window's GLUT callbacks, sound and simulation thread. FrameBench and
+// AllocationTest drive the game through RunGameTicks and RenderGameFrame instead.
 
-// Function to draw the ground
-static void DrawGround() {
-    glPushMatrix();
-    glColor3f(0.5f, 0.35f, 0.05f);  // Brownish color for the ground
-    glBegin(GL_QUADS);
-    glVertex2f(-1.0f, -0.9f);  // Ground above the lower border
-    glVertex2f(-1.0f, -0.7f);
-    glVertex2f(1.0f, -0.7f);
-    glVertex2f(1.0f, -0.9f);
-    glEnd();
-    glPopMatrix();
-}
+static bool endScreenShown = false;  // The end of the round has been drawn and reported
 
-// Display function
-static void Display() {
+// Function to handle game end screen
+static void DisplayGameEnd(const char* message) {
+    const GameWorld& world = shown->world;
     glClear(GL_COLOR_BUFFER_BIT);
+    BatchReset(batch);
 
-    if (gameEnd) {
-        DisplayGameEnd("Game End"); // Display 'Game End' when time runs out
-        return; // Exit early to avoid drawing the game scene
-    }
+    // Background color for the end screen
+    BatchColor(batch, 0.0f, 0.0f, 0.0f);  // Full black background
+    BatchBegin(batch, GL_QUADS);
+    BatchVertex2f(batch, -1.0f, -1.0f);
+    BatchVertex2f(batch, 1.0f, -1.0f);
+    BatchVertex2f(batch, 1.0f, 1.0f);
+    BatchVertex2f(batch, -1.0f, 1.0f);
+    BatchEnd(batch);
 
-    if (gameLose) {
-        DisplayGameEnd("Game Lose"); // Display 'Game Lose' when player loses all lives
-        return; // Exit early to avoid drawing the game scene
+    // Add a decorative border
+    BatchColor(batch, 1.0f, 1.0f, 1.0f);  // White border
+    BatchBegin(batch, GL_LINE_LOOP);
+    BatchVertex2f(batch, -0.6f, -0.4f);
+    BatchVertex2f(batch, 0.6f, -0.4f);
+    BatchVertex2f(batch, 0.6f, 0.6f);
+    BatchVertex2f(batch, -0.6f, 0.6f);
+    BatchEnd(batch);
+    BatchFlush(batch);
+
+    char scoreMessage[50];
+
+    if (glyphAtlas.baked) {
+        if (!TextLabelIsCurrent(endScreenLabel, glyphAtlas, world.score)) {
+            sprintf(scoreMessage, "Your final score is: %d", world.score);
+            ResetTextLabel(endScreenLabel, glyphAtlas, world.score);
+            AppendText(endScreenLabel, glyphAtlas, titleFont, message, -0.16f, 0.2f, 0.8f, 0.0f, 0.0f);  // Blood-red, centered
+            AppendText(endScreenLabel, glyphAtlas, hudFont, scoreMessage, -0.23f, 0.0f, 0.9f, 0.9f, 0.9f);  // Smaller white score
+        }
+        DrawTextLabel(glyphAtlas, endScreenLabel);
     }
+    else {
+        sprintf(scoreMessage, "Your final score is: %d", world.score);
 
+        // Center the text horizontally and vertically
+        glColor3f(0.8f, 0.0f, 0.0f);  // Dark, blood-red color for the text
+        renderBitmapString(-0.16f, 0.2f, GLUT_BITMAP_TIMES_ROMAN_24, message);  // Game End or Lose message
 
-    // Draw the game frame, health bar, score, time, and obstacles
-    DrawGameFrame();
-    DrawBackground();
-    DrawBoundaries();
-    UpdateBackgroundAnimations();
-    DrawGround();
-    DrawHealthBar();
-    DrawScoreAndTime();
-    DrawPlayer();
-    DrawPowerUps();
-    DrawObstacles();  // Add obstacle drawing
-    DrawCollectibles();  // Draw all active collectibles
-    UpdateAnimations();
+        // Display the score in a slightly smaller font, also centered
+        glColor3f(0.9f, 0.9f, 0.9f);  // White color for score text
+        renderBitmapString(-0.23f, 0.0f, GLUT_BITMAP_HELVETICA_18, scoreMessage);
+    }
 
     glFlush();
     glutSwapBuffers();
 }
 
-// Timer function to handle spawning and movement
-static void Timer(int value) {
-    // Update game time
-    int currentTime = (clock() - startTime) / CLOCKS_PER_SEC;
-    gameTime = 60 - currentTime;  // 2-minute countdown
+// Same as GLUT's default reshape, plus telling the text renderer
+static void Reshape(int width, int height) {
+    glViewport(0, 0, width, height);
+    SetTextViewport(glyphAtlas, width, height);
+}
 
-    UpdateBackgroundAnimations(); // Update background animations
-    // Start background music
-    if (gameTime <= 0) {
-        gameEnd = true; // Set game end flag when time runs out
+// Display function
+static void Display() {
+    long long allocationsBefore = ThreadAllocationCount();
+    shown = &snapshots.read();  // Newest state the simulation has handed over
+    const GameWorld& world = shown->world;
+    auto now = std::chrono::steady_clock::now();
+    float sinceTick = std::chrono::duration<float>(now - shown->tickTime).count();
+    renderAlpha = sinceTick < shown->tickSeconds ? sinceTick / (float)shown->tickSeconds : 1.0f;  // Never past the last tick
+    InputStamp frameInput = shown->input;  // Newest input this frame reflects
+    float sinceUpdate = std::chrono::duration<float>(now - lastParticleUpdate).count();
+    lastParticleUpdate = now;
+    AdvanceParticles(sinceUpdate < 0.1f ? sinceUpdate : 0.1f);  // After a stall the sparks just jump ahead a little
+    if (!glyphAtlas.bakeAttempted) {
+        BakeGlyphAtlas(glyphAtlas);  // Draws into the back buffer, so before this frame's clear
     }
+    glClear(GL_COLOR_BUFFER_BIT);
 
-    if (gameEnd || gameLose) {
-        glutPostRedisplay(); // Trigger display to show game end/lose screen
-        if (gameLose == true) {
-            playSoundEffect("C:\\Users\\DELL\\Desktop\\OpenGL2DTemplate\\GameEnd.wav");  // Play hit sound effect
+    if (world.gameEnd || world.gameLose) {
+        if (world.gameEnd) {
+            DisplayGameEnd("Game End"); // Display 'Game End' when time runs out
         }
         else {
-            if (gameEnd == true) {
-                playSoundEffect("C:\\Users\\DELL\\Desktop\\OpenGL2DTemplate\\GameOver.wav");  // Play hit sound effect
+            DisplayGameEnd("Game Lose"); // Display 'Game Lose' when player loses all lives
+        }
+        if (!endScreenShown) {
+            endScreenShown = true;
+            glutIdleFunc(NULL);  // Stop drawing frames
+            ProfileStats latency;
+            if (ComputeInputLatencyStats(inputLatency, latency) > 0) {
+                LOG_INFO("Input to present latency: p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms",
+                         latency.p50, latency.p95, latency.p99, latency.max);
+            }
+            int framesAllocating, ticksAllocating;
+            int frameAllocations = CountProfiledAllocations(profiler, framesAllocating);
+            int tickAllocations = CountProfiledAllocations(tickProfiler, ticksAllocating);
+            if (frameAllocations > 0 || tickAllocations > 0) {
+                LOG_WARN("Heap allocations late in the round: %d in %d recent frames, %d in %d recent ticks",
+                         frameAllocations, framesAllocating, tickAllocations, ticksAllocating);
             }
         }
-
-        return; // Exit early to avoid further game logic
+        return; // Exit early to avoid drawing the game scene
     }
 
-    starSpawnCounter++;
+    DrawScene();
+    glFlush();
+    glutSwapBuffers();
+    RecordPresentedInput(inputLatency, frameInput);
+    profiler.pendingAllocations = (int)(ThreadAllocationCount() - allocationsBefore);
+    EndProfileFrame(profiler);
+}
 
-    // Adjust this number to control how many frames between star additions
-    if (starSpawnCounter > 50) {  // Every 50 frames, add a new star
-        Star star;
-        star.x = ((rand() % 200) - 100) / 100.0f;  // Random X position between -1 and 1
-        star.y = ((rand() % 200) - 100) / 100.0f;  // Random Y position between -1 and 1
-        star.size = 0.005f * (rand() % 3 + 1);     // Random size
-        stars.push_back(star);                      // Add star to the vector
-        starSpawnCounter = 0;                       // Reset counter
+// Save or verify the replay and end the music once the round is over
+static void FinishRound() {
+    if (recordPath != NULL) {
+        FinishReplay(recording, simWorld);
+        if (SaveReplay(recording, recordPath)) {
+            LOG_INFO("Recorded %d ticks of seed %u to %s", (int)recording.inputs.size(), recording.seed, recordPath);
+        }
+        else {
+            LOG_ERROR("Could not write the replay to %s", recordPath);
+        }
     }
-    // Update moon's position
-
-
-    if (knockbackTimer > 0) {
-        knockbackTimer--;  // Decrease knockback timer
-        playerX -= knockbackStrength;  // Move player back while timer lasts
-        if (knockbackTimer == 0) {
-            playerX = -0.8f;  // Reset the player to their original X position
+    if (replaying) {
+        if (ReplayMatches(playback, simWorld)) {
+            LOG_INFO("Replay ended as recorded: score %d", simWorld.score);
+        }
+        else {
+            LOG_WARN("Replay diverged: score %d, recorded %d", simWorld.score, playback.finalScore);
         }
     }
-    // Knockback and Readjustment Logic
-    if (isReadjusting) {
-        if (playerX < -0.8f) {
-            playerX += readjustSpeed;  // Move player back toward original position
-            if (playerX >= -0.8f) {
-                playerX = -0.8f;  // Snap back to original position
-                isReadjusting = false;  // Stop readjusting
-            }
+    StopMusic(audio);
+    if (simWorld.gameLose == true) {
+        PlaySoundEffect(audio, SoundGameEnd);
+    }
+    else {
+        if (simWorld.gameEnd == true) {
+            PlaySoundEffect(audio, SoundGameOver);
         }
     }
-    JumpMechanics();
-    MoveObstacles();  // Move the obstacles and collectables
-    CheckCollisions();  // Check for collisions
-    MoveCollectibles();  // Move all active collectibles
-    CheckCollectibleCollisions();  // Check if any collectibles are collected
-    SpawnCollectibles();  // Spawn new collectibles periodically
-    // Inside the Timer function, right after spawning collectibles
-    MovePowerUps();
-    SpawnPowerUps();  // Spawn new power-ups periodically
-    CheckPowerUpCollisions();
-
-
-    // Increase game speed every 15 seconds
-    if (currentTime % 5 == 0 && currentTime != 0) { // Ensure it doesn't run on the first call
-        gameSpeed += 0.0001f;  // Adjust this value for a steady increase
+}
+
+// Simulation thread: runs as many fixed ticks as real time requires, hands
+// the result over and sleeps until the next tick is due. A slow frame no
+// longer delays ticks or input; the GLUT thread just draws fewer snapshots.
+static void SimulationLoop() {
+    while (simulationRunning.load(std::memory_order_acquire)) {
+        int ticks = AdvanceFixedTimestep(timestep);
+        for (int i = 0; i < ticks && !simWorld.gameEnd && !simWorld.gameLose; i++) {
+            RunTick();
+        }
+        if (demo && (simWorld.gameEnd || simWorld.gameLose)) {
+            StartRound(simWorld.seed + 1);  // Straight on to the next round, without an end screen
+        }
+        if (ticks > 0) {
+            PublishSnapshot();
+        }
+        if (simWorld.gameEnd || simWorld.gameLose) {
+            FinishRound();
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(FixedTimestepWait(timestep)));
     }
+}
 
-    // Randomly spawn obstacles and collectables every 1-2 seconds
-    if (rand() % 50 == 0) { ///or 60
-        SpawnObstacles();
+// Idle function: draws frames back to back while the round runs. The ticks
+// run on the simulation thread, so drawing only has to keep up with the display.
+static void Idle() {
+    glutPostRedisplay();  // Redraw the screen (game scene or game end/lose screen)
+}
 
+// Function to handle key presses
+static void KeyPress(unsigned char key, int, int) {
+    if (key == ' ') {  // Space for jump
+        PushInput(inputQueue, InputJump);
     }
-    // Check if power-ups should be deactivated
-    if (hasMagnet && (clock() - powerUpStartTime) / CLOCKS_PER_SEC >= 5) {
-        hasMagnet = false;  // Deactivate magnet
-        printf("Magnet Power-Up deactivated.\n");
+    if (key == 'd') {  // 'd' for duck, allow ducking in the air
+        PushInput(inputQueue, InputDuckDown);
     }
-
-    if (isInvincible && (clock() - powerUpStartTime) / CLOCKS_PER_SEC >= 5) {
-        isInvincible = false;  // Deactivate invincibility
-        printf("Invincibility Power-Up deactivated.\n");
+    if (key == 'p') {  // 'p' toggles parallax scrolling of the stars
+        starfield.parallax = !starfield.parallax;
+    }
+    if (key == 'f') {  // 'f' toggles the frame profiler overlay
+        profiler.overlayVisible = !profiler.overlayVisible;
     }
-    glutPostRedisplay();  // Redraw the screen
-    glutTimerFunc(16, Timer, 0);  // Call again after 16 ms (~60 FPS)
 }
 
 // Function to handle key releases
-static void KeyRelease(unsigned char key, int x, int y) {
+static void KeyRelease(unsigned char key, int, int) {
     if (key == 'd') {  // Stop ducking
-        isDucking = false;
+        PushInput(inputQueue, InputDuckUp);
+    }
+}
+
+static void ShutdownAudio() {
+    StopAudioMixer(audio);
+}
+
+// Load every sound and start the mixer on the sound device. Sounds that fail
+// to load stay silent; without a device the mixer runs against a null sink.
+static void InitializeAudio() {
+    static const struct {
+        SoundId sound;
+        const char* path;
+    } soundFiles[] = {
+        { SoundCoin, "coin.wav" },
+        { SoundObstacle, "obstacle.wav" },
+        { SoundMagnet, "Magnet.wav" },
+        { SoundInvincible, "invincible.wav" },
+        { SoundGameOver, "GameOver.wav" },
+        { SoundGameEnd, "GameEnd.wav" },
+        { SoundMusic, "Mice_on_Venus.wav" },
+    };
+    InitAudioMixer(audio);
+    for (const auto& file : soundFiles) {
+        if (!LoadSound(audio, file.sound, file.path)) {
+            LOG_WARN("Could not load %s", file.path);
+        }
     }
+    StartAudioMixer(audio, CreateDeviceSink());
+    atexit(ShutdownAudio);  // GLUT exits from inside glutMainLoop
 }
 
-// Main function
+static void StartSimulation() {
+    simulationRunning.store(true, std::memory_order_release);
+    simulationThread = std::thread(SimulationLoop);
+}
+
+static void StopSimulation() {
+    simulationRunning.store(false, std::memory_order_release);
+    if (simulationThread.joinable()) {
+        simulationThread.join();
+    }
+}
+
+// Main function. Usage: QuickRunner [--record FILE] [--replay FILE [--speed X]] [--demo]
+// --record saves the round for later playback; --replay plays a recorded
+// round back at X times normal speed (1 by default); --demo lets the
+// lookahead bot (InputPolicy.h) play endlessly.
 int main(int argc, char** argv) {
-    srand(static_cast<unsigned>(time(0)));  // Seed for random numbers
-    playSoundEffect("C:\\Users\\DELL\\Desktop\\OpenGL2DTemplate\\Mice_on_Venus.wav");  // Play hit sound effect
+    glutInit(&argc, argv);  // Takes out GLUT's own arguments
+    const char* replayPath = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc && atof(argv[i + 1]) > 0.0) {
+            timeScale = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--demo") == 0) {
+            demo = true;
+        }
+        else {
+            printf("Usage: %s [--record FILE] [--replay FILE [--speed X]] [--demo]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (demo && (recordPath != NULL || replayPath != NULL)) {
+        printf("--demo plays endless rounds of its own and cannot be recorded or replayed\n");
+        return 1;
+    }
+
+    StartLogger();
+    atexit(StopLogger);  // Registered first so it runs last and flushes everything
+    InitializeAudio();
+    PlayMusic(audio, SoundMusic);
 
-    glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
     glutInitWindowSize(800, 600);
     glutCreateWindow("Marwan's cute 2D Infinite Runner");
-    glClearColor(0.1f, 0.1f, 0.3f, 1.0f);  // Dark blue background
-
-
-    gluOrtho2D(-1.0, 1.0, -1.0, 1.0);  // Set the coordinate system
-    startTime = clock();  // Record start time
+    InitializeGame(true);
+    if (replayPath != NULL) {
+        if (!StartReplay(replayPath)) {
+            LOG_ERROR("Cannot read replay %s", replayPath);
+            return 1;
+        }
+    }
+    else {
+        RestartGame(static_cast<unsigned>(time(0)));  // A new round every run
+    }
     glutDisplayFunc(Display);
+    glutReshapeFunc(Reshape);
     glutKeyboardFunc(KeyPress);
     glutKeyboardUpFunc(KeyRelease);
-    glutTimerFunc(0, Timer, 0);
+    glutIdleFunc(Idle);
+    StartSimulation();
+    atexit(StopSimulation);  // After InitializeGame's handlers, so it runs before the chunk feed stops
     glutMainLoop();
 
     return 0;
 }
+
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+// Entry points into the game front end besides main(), for drivers that
+// bring their own GL context (FrameBench.cpp). Such drivers compile
+// QuickRunnerIO.cpp with QUICKRUNNER_NO_MAIN.
+
+// Everything main() does once the window exists, except starting a round
+// (RestartGame or StartReplay). Requires a current GL context. Without
+// hudText no GLUT font is used, so GLUT need not be initialized.
+void InitializeGame(bool hudText);
+
+// Start a fresh round with the given random seed. This and the calls below
+// simulate on the calling thread, so drivers use them instead of the
+// simulation thread main() runs the game on.
+void RestartGame(unsigned int seed);
+
+// Play a recorded round (see Replay.h) from its start, with its inputs
+// instead of the keyboard's. False if the file cannot be read.
+bool StartReplay(const char* path);
+
+// Simulate ticks with the current input source, starting a new round
+// (or the replay again) whenever one ends
+void RunGameTicks(int ticks);
+
+// Draw the state after the last simulated tick into the current
+// framebuffer, without swapping
+void RenderGameFrame();
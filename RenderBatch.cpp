@@ -0,0 +1,216 @@
+#include "RenderBatch.h"
+
+#include <cstddef>
+#include <cstring>
+#include "GLExtensions.h"
+#include "ShapeCache.h"
+
+const size_t kReservedVertices = 16384;  // Enough for a busy frame; vectors only grow past this
+
+static unsigned char ToColorByte(float value) {
+    if (value <= 0.0f) {
+        return 0;
+    }
+    if (value >= 1.0f) {
+        return 255;
+    }
+    return (unsigned char)(value * 255.0f + 0.5f);
+}
+
+void InitRenderBatch(RenderBatch& batch) {
+    batch.triangles.reserve(kReservedVertices);
+    batch.lines.reserve(kReservedVertices / 4);
+    batch.primitive.reserve(1024);
+    batch.vertexBuffer = 0;
+    if (glExt.hasVertexBuffers) {
+        glExt.GenBuffers(1, &batch.vertexBuffer);
+    }
+    batch.drawCalls = 0;
+    batch.vertexCount = 0;
+    BatchReset(batch);
+}
+
+void BatchReset(RenderBatch& batch) {
+    batch.triangles.clear();
+    batch.lines.clear();
+    batch.primitive.clear();
+    batch.matrixDepth = 0;
+    batch.matrix[0] = 1.0f; batch.matrix[1] = 0.0f;
+    batch.matrix[2] = 0.0f; batch.matrix[3] = 1.0f;
+    batch.matrix[4] = 0.0f; batch.matrix[5] = 0.0f;
+    BatchColor(batch, 1.0f, 1.0f, 1.0f);
+}
+
+void BatchBegin(RenderBatch& batch, GLenum mode) {
+    batch.primitiveMode = mode;
+    batch.primitive.clear();
+}
+
+void BatchVertex2f(RenderBatch& batch, float x, float y) {
+    const float* m = batch.matrix;
+    BatchVertex vertex;
+    vertex.x = m[0] * x + m[2] * y + m[4];
+    vertex.y = m[1] * x + m[3] * y + m[5];
+    vertex.r = batch.color[0];
+    vertex.g = batch.color[1];
+    vertex.b = batch.color[2];
+    vertex.a = batch.color[3];
+    batch.primitive.push_back(vertex);
+}
+
+// Split a convex polygon into a triangle fan around its first vertex
+static void EmitFan(std::vector<BatchVertex>& out, const BatchVertex* vertices, size_t count) {
+    for (size_t i = 1; i + 1 < count; i++) {
+        out.push_back(vertices[0]);
+        out.push_back(vertices[i]);
+        out.push_back(vertices[i + 1]);
+    }
+}
+
+void BatchEnd(RenderBatch& batch) {
+    const std::vector<BatchVertex>& v = batch.primitive;
+    size_t count = v.size();
+
+    switch (batch.primitiveMode) {
+    case GL_TRIANGLES:
+        batch.triangles.insert(batch.triangles.end(), v.begin(), v.begin() + count / 3 * 3);
+        break;
+    case GL_QUADS:
+        for (size_t i = 0; i + 3 < count; i += 4) {
+            EmitFan(batch.triangles, &v[i], 4);
+        }
+        break;
+    case GL_POLYGON:
+    case GL_TRIANGLE_FAN:
+        if (count >= 3) {
+            EmitFan(batch.triangles, &v[0], count);
+        }
+        break;
+    case GL_LINES:
+        batch.lines.insert(batch.lines.end(), v.begin(), v.begin() + count / 2 * 2);
+        break;
+    case GL_LINE_LOOP:
+        for (size_t i = 0; count >= 2 && i < count; i++) {
+            batch.lines.push_back(v[i]);
+            batch.lines.push_back(v[(i + 1) % count]);
+        }
+        break;
+    default:
+        break;
+    }
+    batch.primitive.clear();
+}
+
+void BatchShape(RenderBatch& batch, GLenum mode, const float* points, int count, float x, float y, float scale) {
+    BatchBegin(batch, mode);
+    for (int i = 0; i < count; i++) {
+        BatchVertex2f(batch, x + scale * points[2 * i], y + scale * points[2 * i + 1]);
+    }
+    BatchEnd(batch);
+}
+
+static void AppendTransformed(const RenderBatch& batch, std::vector<BatchVertex>& out, const BatchVertex* vertices, int count) {
+    const float* m = batch.matrix;
+    for (int i = 0; i < count; i++) {
+        BatchVertex vertex = vertices[i];
+        vertex.x = m[0] * vertices[i].x + m[2] * vertices[i].y + m[4];
+        vertex.y = m[1] * vertices[i].x + m[3] * vertices[i].y + m[5];
+        out.push_back(vertex);
+    }
+}
+
+void BatchMesh(RenderBatch& batch, const BatchVertex* triangles, int triangleCount, const BatchVertex* lines, int lineCount) {
+    AppendTransformed(batch, batch.triangles, triangles, triangleCount);
+    AppendTransformed(batch, batch.lines, lines, lineCount);
+}
+
+void BatchColor(RenderBatch& batch, float r, float g, float b, float a) {
+    batch.color[0] = ToColorByte(r);
+    batch.color[1] = ToColorByte(g);
+    batch.color[2] = ToColorByte(b);
+    batch.color[3] = ToColorByte(a);
+}
+
+void BatchPushMatrix(RenderBatch& batch) {
+    if (batch.matrixDepth < 16) {
+        memcpy(batch.matrixStack[batch.matrixDepth], batch.matrix, sizeof(batch.matrix));
+    }
+    batch.matrixDepth++;
+}
+
+void BatchPopMatrix(RenderBatch& batch) {
+    batch.matrixDepth--;
+    if (batch.matrixDepth < 16) {
+        memcpy(batch.matrix, batch.matrixStack[batch.matrixDepth], sizeof(batch.matrix));
+    }
+}
+
+void BatchTranslate(RenderBatch& batch, float x, float y) {
+    float* m = batch.matrix;
+    m[4] += m[0] * x + m[2] * y;
+    m[5] += m[1] * x + m[3] * y;
+}
+
+void BatchScale(RenderBatch& batch, float x, float y) {
+    float* m = batch.matrix;
+    m[0] *= x; m[1] *= x;
+    m[2] *= y; m[3] *= y;
+}
+
+void BatchRotate(RenderBatch& batch, float degrees) {
+    float s, c;
+    SinCosDegrees(degrees, s, c);
+    float* m = batch.matrix;
+    float a = m[0], b = m[1], cc = m[2], d = m[3];
+    m[0] = a * c + cc * s;
+    m[1] = b * c + d * s;
+    m[2] = cc * c - a * s;
+    m[3] = d * c - b * s;
+}
+
+void BatchFlush(RenderBatch& batch) {
+    size_t triangleCount = batch.triangles.size();
+    size_t lineCount = batch.lines.size();
+    size_t stride = sizeof(BatchVertex);
+    batch.drawCalls = 0;
+    batch.vertexCount = (int)(triangleCount + lineCount);
+    if (batch.vertexCount == 0) {
+        return;
+    }
+
+    const char* base;
+    if (batch.vertexBuffer != 0) {
+        // Orphan last frame's storage and stream this frame's vertices in
+        glExt.BindBuffer(GL_ARRAY_BUFFER, batch.vertexBuffer);
+        glExt.BufferData(GL_ARRAY_BUFFER, (ptrdiff_t)(batch.vertexCount * stride), NULL, GL_STREAM_DRAW);
+        glExt.BufferSubData(GL_ARRAY_BUFFER, 0, (ptrdiff_t)(triangleCount * stride), batch.triangles.data());
+        glExt.BufferSubData(GL_ARRAY_BUFFER, (ptrdiff_t)(triangleCount * stride), (ptrdiff_t)(lineCount * stride), batch.lines.data());
+        base = NULL;  // Offsets into the buffer
+    }
+    else {
+        // No VBO support: draw from client memory. Lines are appended after the
+        // triangles so one pointer setup serves both draws.
+        batch.triangles.insert(batch.triangles.end(), batch.lines.begin(), batch.lines.end());
+        base = (const char*)batch.triangles.data();
+    }
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, (GLsizei)stride, base);
+    glColorPointer(4, GL_UNSIGNED_BYTE, (GLsizei)stride, base + offsetof(BatchVertex, r));
+
+    if (triangleCount > 0) {
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)triangleCount);
+        batch.drawCalls++;
+    }
+    if (lineCount > 0) {
+        glDrawArrays(GL_LINES, (GLint)triangleCount, (GLsizei)lineCount);
+        batch.drawCalls++;
+    }
+
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    if (batch.vertexBuffer != 0) {
+        glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include "GLIncludes.h"
+
+// One vertex of the frame's vertex stream: position already transformed to
+// screen coordinates plus an RGBA color
+struct BatchVertex {
+    float x, y;
+    unsigned char r, g, b, a;
+};
+
+// CPU-side replacement for immediate mode. Draw code keeps the familiar
+// begin / color / vertex / end sequence and matrix stack, but vertices are
+// transformed on the CPU and appended to one interleaved stream per primitive
+// type. BatchFlush uploads the whole frame once and issues one draw call per
+// primitive type (triangles, then lines).
+struct RenderBatch {
+    std::vector<BatchVertex> triangles;  // Filled shapes, as independent triangles
+    std::vector<BatchVertex> lines;      // Outlines, as independent line segments
+    std::vector<BatchVertex> primitive;  // Vertices of the primitive being built
+    GLenum primitiveMode;                // Mode passed to BatchBegin
+
+    float matrix[6];                     // Current 2D affine transform (a, b, c, d, tx, ty)
+    float matrixStack[16][6];
+    int matrixDepth;
+    unsigned char color[4];              // Current color, as set by BatchColor
+
+    GLuint vertexBuffer;                 // Streamed once per frame (0 if VBOs are unavailable)
+    int drawCalls;                       // Draw calls issued by the last BatchFlush
+    int vertexCount;                     // Vertices submitted by the last BatchFlush
+};
+
+// Create the vertex buffer and reserve space. Requires a current GL context.
+void InitRenderBatch(RenderBatch& batch);
+
+// Start a new frame: drop last frame's vertices and reset the transform
+void BatchReset(RenderBatch& batch);
+
+// Immediate-mode style primitive building. Supports GL_TRIANGLES, GL_QUADS,
+// GL_POLYGON, GL_TRIANGLE_FAN, GL_LINES and GL_LINE_LOOP.
+void BatchBegin(RenderBatch& batch, GLenum mode);
+void BatchVertex2f(RenderBatch& batch, float x, float y);
+void BatchEnd(RenderBatch& batch);
+void BatchColor(RenderBatch& batch, float r, float g, float b, float a = 1.0f);
+
+// Emit a whole primitive from an array of count x, y pairs, placed at (x, y)
+// and scaled by scale before the current transform. Same modes as BatchBegin.
+void BatchShape(RenderBatch& batch, GLenum mode, const float* points, int count, float x, float y, float scale);
+
+// Append prebuilt triangles and line segments (with their own colors) through
+// the current transform
+void BatchMesh(RenderBatch& batch, const BatchVertex* triangles, int triangleCount, const BatchVertex* lines, int lineCount);
+
+// Matrix stack equivalents of glPushMatrix / glTranslatef / glScalef / glRotatef
+void BatchPushMatrix(RenderBatch& batch);
+void BatchPopMatrix(RenderBatch& batch);
+void BatchTranslate(RenderBatch& batch, float x, float y);
+void BatchScale(RenderBatch& batch, float x, float y);
+void BatchRotate(RenderBatch& batch, float degrees);
+
+// Upload the frame's vertices and draw them
+void BatchFlush(RenderBatch& batch);
@@ -0,0 +1,165 @@
+#include "Replay.h"
+
+#include <cstdio>
+#include <cstring>
+
+const unsigned int kReplayVersion = 2;  // 2: power-ups stack and expire independently
+
+void BeginReplay(Replay& replay, unsigned int seed) {
+    replay.seed = seed;
+    replay.inputs.clear();
+    replay.inputs.reserve(kReplayRoundTicks);  // A whole round, so recording never reallocates
+    replay.finalScore = 0;
+    replay.finalLives = 0;
+    replay.finalTick = 0;
+}
+
+void RecordReplayTick(Replay& replay, const TickInput& input) {
+    replay.inputs.push_back((unsigned char)((input.jumpPressed ? ReplayJump : 0) | (input.duckHeld ? ReplayDuck : 0)));
+}
+
+void FinishReplay(Replay& replay, const GameWorld& world) {
+    replay.finalScore = world.score;
+    replay.finalLives = world.lives;
+    replay.finalTick = world.tick;
+}
+
+TickInput ReplayInput(const Replay& replay, long tick) {
+    TickInput input = {};
+    if (tick >= 0 && tick < (long)replay.inputs.size()) {
+        input.jumpPressed = (replay.inputs[tick] & ReplayJump) != 0;
+        input.duckHeld = (replay.inputs[tick] & ReplayDuck) != 0;
+    }
+    return input;
+}
+
+bool PlayReplay(const Replay& replay, GameWorld& world) {
+    InitGameWorld(world, replay.seed);
+    for (long tick = 0; tick < (long)replay.inputs.size(); tick++) {
+        StepGameWorld(world, ReplayInput(replay, tick));
+    }
+    return ReplayMatches(replay, world);
+}
+
+bool ReplayMatches(const Replay& replay, const GameWorld& world) {
+    return world.score == replay.finalScore && world.lives == replay.finalLives && world.tick == replay.finalTick;
+}
+
+static void WriteLE(std::vector<unsigned char>& bytes, unsigned int value) {
+    for (int i = 0; i < 4; i++) {
+        bytes.push_back((unsigned char)(value >> (8 * i)));
+    }
+}
+
+static void WriteVarint(std::vector<unsigned char>& bytes, unsigned int value) {
+    while (value >= 0x80) {
+        bytes.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back((unsigned char)value);
+}
+
+bool SaveReplay(const Replay& replay, const char* path) {
+    std::vector<unsigned char> bytes(4);
+    memcpy(&bytes[0], "QRRP", 4);
+    WriteLE(bytes, kReplayVersion);
+    WriteLE(bytes, replay.seed);
+    WriteLE(bytes, (unsigned int)replay.inputs.size());
+    WriteLE(bytes, (unsigned int)replay.finalScore);
+    WriteLE(bytes, (unsigned int)replay.finalLives);
+    WriteLE(bytes, (unsigned int)replay.finalTick);
+    size_t start = 0;
+    while (start < replay.inputs.size()) {
+        size_t end = start + 1;
+        while (end < replay.inputs.size() && replay.inputs[end] == replay.inputs[start]) {
+            end++;
+        }
+        bytes.push_back(replay.inputs[start]);
+        WriteVarint(bytes, (unsigned int)(end - start));
+        start = end;
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    bool written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return fclose(file) == 0 && written;
+}
+
+// Reads the file sequentially; any read past the end marks it as truncated
+struct ReplayReader {
+    const unsigned char* data;
+    size_t size;
+    size_t position;
+    bool truncated;
+
+    unsigned char byte() {
+        if (position >= size) {
+            truncated = true;
+            return 0;
+        }
+        return data[position++];
+    }
+
+    unsigned int le32() {
+        unsigned int value = 0;
+        for (int i = 0; i < 4; i++) {
+            value |= (unsigned int)byte() << (8 * i);
+        }
+        return value;
+    }
+
+    unsigned int varint() {
+        unsigned int value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            unsigned char next = byte();
+            value |= (unsigned int)(next & 0x7F) << shift;
+            if ((next & 0x80) == 0) {
+                return value;
+            }
+        }
+        truncated = true;  // Longer than any 32-bit value
+        return 0;
+    }
+};
+
+bool LoadReplay(Replay& replay, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    std::vector<unsigned char> bytes;
+    unsigned char chunk[4096];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        bytes.insert(bytes.end(), chunk, chunk + read);
+    }
+    fclose(file);
+
+    if (bytes.size() < 4 || memcmp(&bytes[0], "QRRP", 4) != 0) {
+        return false;
+    }
+    ReplayReader reader = { bytes.data(), bytes.size(), 4, false };
+    if (reader.le32() != kReplayVersion) {
+        return false;
+    }
+    replay.seed = reader.le32();
+    unsigned int ticks = reader.le32();
+    replay.finalScore = (int)reader.le32();
+    replay.finalLives = (int)reader.le32();
+    replay.finalTick = (long)(int)reader.le32();
+    if (ticks > (unsigned int)kReplayRoundTicks) {
+        return false;  // Longer than any round, so the file is damaged; the runs below are bounded by ticks
+    }
+    replay.inputs.clear();
+    while (!reader.truncated && replay.inputs.size() < ticks) {
+        unsigned char input = reader.byte();
+        unsigned int run = reader.varint();
+        if (run > ticks - replay.inputs.size()) {
+            return false;  // Runs add up to more ticks than the header says
+        }
+        replay.inputs.insert(replay.inputs.end(), run, input);
+    }
+    return !reader.truncated && replay.inputs.size() == ticks;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include "GameWorld.h"
+
+// Recording of one round: its seed and the input of every tick. Stepping a
+// world started from the same seed with the same inputs rebuilds the round
+// exactly, so a replay from a player reproduces their gameplay bug or frame
+// time spike, and doubles as a fixed workload for benchmarks.
+//
+// File format (integers little-endian):
+//   "QRRP", uint32 version, uint32 seed, uint32 ticks,
+//   int32 final score, int32 final lives, int32 final world tick,
+//   then the inputs as runs: one byte of ReplayInputBits followed by the run
+//   length as a LEB128 varint. A round of running with a few jumps and ducks
+//   takes a few hundred bytes.
+
+enum ReplayInputBits {
+    ReplayJump = 1,
+    ReplayDuck = 2
+};
+
+// Inputs recorded in a full round: one per tick of its duration, plus the
+// tick that ends it
+const int kReplayRoundTicks = kGameDurationSeconds * kTicksPerSecond + 1;
+
+struct Replay {
+    unsigned int seed;
+    std::vector<unsigned char> inputs;  // One byte of ReplayInputBits per StepGameWorld call
+    // Outcome of the recorded round, to verify playback against
+    int finalScore;
+    int finalLives;
+    long finalTick;
+};
+
+// Start recording a round started with InitGameWorld(world, seed). Room for
+// a whole round's inputs is reserved here, so recording ticks never allocates.
+void BeginReplay(Replay& replay, unsigned int seed);
+
+// Append the input passed to one StepGameWorld call
+void RecordReplayTick(Replay& replay, const TickInput& input);
+
+// Store the outcome after the last recorded tick
+void FinishReplay(Replay& replay, const GameWorld& world);
+
+// Input of the given tick; no input past the end of the recording
+TickInput ReplayInput(const Replay& replay, long tick);
+
+// Play the whole recording into world as fast as possible. Returns whether
+// it ended exactly as recorded.
+bool PlayReplay(const Replay& replay, GameWorld& world);
+
+// Whether world, after playing every tick, ended as recorded
+bool ReplayMatches(const Replay& replay, const GameWorld& world);
+
+// False if the file cannot be written / read or is not a replay (including one
+// longer than kReplayRoundTicks)
+bool SaveReplay(const Replay& replay, const char* path);
+bool LoadReplay(Replay& replay, const char* path);
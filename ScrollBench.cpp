@@ -0,0 +1,80 @@
+// Microbenchmark for the entity scroll kernels (EntityKernels.h): moves a
+// column of entities with every kernel this CPU supports and reports the
+// throughput.
+//
+// Usage: ScrollBench [entities] [passes]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "EntityKernels.h"
+
+struct NamedKernel {
+    const char* name;
+    ScrollKernel kernel;
+    bool supported;
+};
+
+// Spread the entities over -1.5 .. 1.5 so about a sixth of them are off-screen
+static void FillColumn(std::vector<float>& x, unsigned seed) {
+    srand(seed);
+    for (size_t i = 0; i < x.size(); i++) {
+        x[i] = -1.5f + 3.0f * rand() / (float)RAND_MAX;
+    }
+}
+
+int main(int argc, char** argv) {
+    int entities = argc > 1 ? atoi(argv[1]) : 1000000;
+    int passes = argc > 2 ? atoi(argv[2]) : 200;
+    if (entities <= 0 || passes <= 0) {
+        printf("Usage: %s [entities] [passes]\n", argv[0]);
+        return 1;
+    }
+
+    NamedKernel kernels[] = {
+        { "scalar", ScrollEntitiesScalar, true },
+        { "sse2", ScrollEntitiesSSE2, CpuHasSSE2() },
+        { "avx2", ScrollEntitiesAVX2, CpuHasAVX2() },
+    };
+    const float speed = 1e-6f;  // Small enough that the column barely changes over all passes
+    const float limit = -1.0f;
+
+    std::vector<float> reference(entities);
+    std::vector<float> x(entities);
+    std::vector<float> prevX(entities);
+    FillColumn(reference, 1);
+
+    // Every kernel has to agree with the scalar one before it is timed
+    std::vector<float> expected = reference;
+    int expectedBelow = ScrollEntitiesScalar(expected.data(), prevX.data(), entities, speed, limit);
+
+    printf("entities: %d\n", entities);
+    printf("passes: %d\n", passes);
+    printf("dispatch: %s\n", BestScrollKernelName());
+    for (const NamedKernel& kernel : kernels) {
+        if (!kernel.supported) {
+            printf("%-8s unsupported\n", kernel.name);
+            continue;
+        }
+
+        x = reference;
+        int below = kernel.kernel(x.data(), prevX.data(), entities, speed, limit);
+        bool matches = below == expectedBelow && memcmp(x.data(), expected.data(), entities * sizeof(float)) == 0;
+
+        x = reference;
+        long long checksum = 0;  // Keeps the work observable
+        auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; pass++) {
+            checksum += kernel.kernel(x.data(), prevX.data(), entities, speed, limit);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double seconds = std::chrono::duration<double>(end - start).count();
+        double millionsPerSecond = (double)entities * passes / seconds / 1e6;
+        double msPerMillion = seconds * 1e3 / passes * (1e6 / entities);
+        printf("%-8s %8.1f M entities/s  %7.3f ms per million  %s  (checksum %lld)\n",
+               kernel.name, millionsPerSecond, msPerMillion, matches ? "ok" : "MISMATCH", checksum);
+    }
+    return 0;
+}
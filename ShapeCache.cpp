@@ -0,0 +1,110 @@
+#include "ShapeCache.h"
+
+#include <cmath>
+#include <vector>
+
+const double kPi = 3.14159265358979323846;
+const int kSineTableSize = 4096;  // Entries per full turn; linear interpolation in between
+
+static std::vector<float> shapePoints[ShapeCount];
+static Shape shapes[ShapeCount];
+static float sineTable[kSineTableSize + 1];
+
+static void AddPoint(std::vector<float>& points, double x, double y) {
+    points.push_back((float)x);
+    points.push_back((float)y);
+}
+
+// count points on the unit circle starting at angle 0; closed repeats the first point
+static void AddCircle(std::vector<float>& points, int count, bool closed) {
+    int last = closed ? count : count - 1;
+    for (int i = 0; i <= last; i++) {
+        double theta = 2.0 * kPi * i / count;
+        AddPoint(points, cos(theta), sin(theta));
+    }
+}
+
+// Arc of the unit circle from startDegrees to endDegrees in 5 degree steps
+static void AddArc(std::vector<float>& points, int startDegrees, int endDegrees) {
+    for (int i = startDegrees; i <= endDegrees; i += 5) {
+        double theta = i * kPi / 180.0;
+        AddPoint(points, cos(theta), sin(theta));
+    }
+}
+
+ShapeDetail DefaultShapeDetail() {
+    ShapeDetail detail;
+    detail.heartSegments = 64;
+    detail.collectibleSegments = 20;
+    detail.moonSegments = 30;
+    detail.helmetSegments = 30;
+    return detail;
+}
+
+void InitShapeCache(const ShapeDetail& detail) {
+    for (int i = 0; i < ShapeCount; i++) {
+        shapePoints[i].clear();
+    }
+
+    // Heart curve: x = 16 sin^3 t, y = 13 cos t - 5 cos 2t - 2 cos 3t - cos 4t
+    for (int i = 0; i < detail.heartSegments; i++) {
+        double t = 2.0 * kPi * i / detail.heartSegments;
+        AddPoint(shapePoints[ShapeHeart], 16.0 * pow(sin(t), 3),
+                 13.0 * cos(t) - 5.0 * cos(2 * t) - 2.0 * cos(3 * t) - cos(4 * t));
+    }
+
+    AddCircle(shapePoints[ShapeCollectibleDisc], detail.collectibleSegments, false);
+
+    // Five outer points with an inner point (half radius) between each pair
+    for (int i = 0; i < 5; i++) {
+        double angle = i * (2.0 * kPi / 5);
+        AddPoint(shapePoints[ShapeCollectibleStar], cos(angle), sin(angle));
+        angle += kPi / 5;
+        AddPoint(shapePoints[ShapeCollectibleStar], 0.5 * cos(angle), 0.5 * sin(angle));
+    }
+
+    AddCircle(shapePoints[ShapeMoonDisc], detail.moonSegments, false);
+    AddPoint(shapePoints[ShapeMoonGlow], 0.0, 0.0);
+    AddCircle(shapePoints[ShapeMoonGlow], detail.moonSegments, true);
+
+    AddPoint(shapePoints[ShapeHelmet], 0.0, 0.0);
+    for (int i = 0; i <= detail.helmetSegments; i++) {
+        double theta = (double)i / detail.helmetSegments * kPi;  // Half circle for the dome
+        AddPoint(shapePoints[ShapeHelmet], cos(theta), sin(theta));
+    }
+
+    AddPoint(shapePoints[ShapeMagnetLeftArc], 0.0, 0.0);
+    AddArc(shapePoints[ShapeMagnetLeftArc], 180, 270);
+    AddPoint(shapePoints[ShapeMagnetRightArc], 0.0, 0.0);
+    AddArc(shapePoints[ShapeMagnetRightArc], 270, 360);
+
+    AddCircle(shapePoints[ShapeSkyStar], 5, false);
+    AddCircle(shapePoints[ShapeAsteroid], 7, false);
+
+    for (int i = 0; i < ShapeCount; i++) {
+        shapes[i].points = shapePoints[i].data();
+        shapes[i].count = (int)shapePoints[i].size() / 2;
+    }
+
+    for (int i = 0; i <= kSineTableSize; i++) {
+        sineTable[i] = (float)sin(2.0 * kPi * i / kSineTableSize);
+    }
+}
+
+const Shape& GetShape(ShapeId id) {
+    return shapes[id];
+}
+
+// Sine of an angle given in table steps, with linear interpolation
+static float TableSine(float steps) {
+    float whole = floorf(steps);
+    float fraction = steps - whole;
+    int index = (int)whole & (kSineTableSize - 1);
+    return sineTable[index] + (sineTable[index + 1] - sineTable[index]) * fraction;
+}
+
+void SinCosDegrees(float degrees, float& sine, float& cosine) {
+    float steps = degrees * (kSineTableSize / 360.0f);
+    sine = TableSine(steps);
+    cosine = TableSine(steps + kSineTableSize / 4);
+}
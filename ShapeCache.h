@@ -0,0 +1,43 @@
+#pragma once
+
+// Unit shapes used by the draw functions, tessellated once at startup. The
+// draw code places them with the batch transform (translate / scale / rotate),
+// so drawing a frame needs no trigonometry at all.
+
+enum ShapeId {
+    ShapeHeart,              // Parametric heart, about 32 x 29 units across (scale by heart size)
+    ShapeCollectibleDisc,    // Unit circle for the collectible body and its outer ring
+    ShapeCollectibleStar,    // Collectible star: alternating outer / inner points, drawn as GL_TRIANGLES
+    ShapeMoonDisc,           // Unit circle for the moon body
+    ShapeMoonGlow,           // Centre, then a closed unit circle (last point repeats the first) for the glow fan
+    ShapeHelmet,             // Upper half circle, centre first, for the helmet fan
+    ShapeMagnetLeftArc,      // Quarter arc 180..270 degrees, centre first
+    ShapeMagnetRightArc,     // Quarter arc 270..360 degrees, centre first
+    ShapeSkyStar,            // Pentagon for background stars
+    ShapeAsteroid,           // Heptagon for the boundary asteroids
+    ShapeCount
+};
+
+// Tessellation detail. The defaults match the old immediate-mode code except
+// for the heart, which used 629 points where 64 look the same at HUD size.
+struct ShapeDetail {
+    int heartSegments;
+    int collectibleSegments;
+    int moonSegments;
+    int helmetSegments;
+};
+
+struct Shape {
+    const float* points;     // x, y pairs
+    int count;               // Number of points
+};
+
+ShapeDetail DefaultShapeDetail();
+
+// Tessellate every shape and build the sine table. Call once before drawing.
+void InitShapeCache(const ShapeDetail& detail);
+
+const Shape& GetShape(ShapeId id);
+
+// Table-based sine and cosine for an angle in degrees (any range)
+void SinCosDegrees(float degrees, float& sine, float& cosine);
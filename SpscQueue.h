@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+
+// Bounded lock-free queue for handing items from one thread to another.
+// Exactly one thread may push and exactly one (other) thread may pop. Neither
+// side ever blocks or allocates: push fails when the queue is full and pop
+// when it is empty.
+template <typename T, int Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    // Producer side. False (item dropped) if the queue is full.
+    bool push(const T& item) {
+        unsigned int back = tail.load(std::memory_order_relaxed);
+        if (back - head.load(std::memory_order_acquire) == (unsigned int)Capacity) {
+            return false;
+        }
+        items[back & (Capacity - 1)] = item;
+        tail.store(back + 1, std::memory_order_release);  // Publishes the item to the consumer
+        return true;
+    }
+
+    // Consumer side. False if the queue is empty.
+    bool pop(T& item) {
+        unsigned int front = head.load(std::memory_order_relaxed);
+        if (front == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[front & (Capacity - 1)];
+        head.store(front + 1, std::memory_order_release);  // Hands the slot back to the producer
+        return true;
+    }
+
+private:
+    // The counters only ever increase and wrap around together; each lives on
+    // its own cache line so the two threads do not fight over one line
+    alignas(64) std::atomic<unsigned int> head;  // Next item to pop, written by the consumer
+    alignas(64) std::atomic<unsigned int> tail;  // Next free slot, written by the producer
+    alignas(64) T items[Capacity];
+};
@@ -0,0 +1,59 @@
+#include "Starfield.h"
+
+#include <cmath>
+
+// Integer hash with good avalanche, used as a stateless random source
+static unsigned HashStarCell(unsigned a, unsigned b, unsigned c, unsigned seed) {
+    unsigned h = seed ^ 0x9E3779B9u;
+    h ^= a + 0x7F4A7C15u + (h << 6) + (h >> 2);
+    h ^= b + 0x85EBCA6Bu + (h << 6) + (h >> 2);
+    h ^= c + 0xC2B2AE35u + (h << 6) + (h >> 2);
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return h;
+}
+
+// Far layers scroll slower than near ones
+static float LayerScrollSpeed(int layer) {
+    return 0.1f * (float)(layer + 1);
+}
+
+int StarfieldBudget(const Starfield& field) {
+    // With parallax a partially scrolled-in column is visible at the right edge
+    int columns = field.parallax ? field.columns + 1 : field.columns;
+    return field.layers * field.rows * columns;
+}
+
+StarfieldStar GetStarfieldStar(const Starfield& field, int layer, int column, int row, float scroll) {
+    float cellWidth = 2.0f / field.columns;
+    float cellHeight = 2.0f / field.rows;
+    unsigned h = HashStarCell((unsigned)column, (unsigned)row, (unsigned)layer, field.seed);
+
+    StarfieldStar star;
+    star.x = -1.0f + (column + (h & 0xFFFF) / 65536.0f) * cellWidth - scroll;
+    star.y = -1.0f + (row + ((h >> 16) & 0x3FFF) / 16384.0f) * cellHeight;
+    star.size = 0.005f * (((h >> 30) % 3) + 1);  // Random size (small to medium)
+    if (layer + 1 < field.layers) {
+        star.size *= 0.5f + 0.5f * (layer + 1) / field.layers;  // Far stars look smaller
+    }
+    return star;
+}
+
+int BuildStarfield(const Starfield& field, float distance, StarfieldStar* out) {
+    float cellWidth = 2.0f / field.columns;
+    int count = 0;
+    for (int layer = 0; layer < field.layers; layer++) {
+        float scroll = field.parallax ? distance * LayerScrollSpeed(layer) : 0.0f;
+        int firstColumn = (int)floorf(scroll / cellWidth);
+        int columns = field.parallax ? field.columns + 1 : field.columns;
+        for (int column = firstColumn; column < firstColumn + columns; column++) {
+            for (int row = 0; row < field.rows; row++) {
+                out[count++] = GetStarfieldStar(field, layer, column, row, scroll);
+            }
+        }
+    }
+    return count;
+}
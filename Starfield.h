@@ -0,0 +1,29 @@
+#pragma once
+
+// Procedural starfield. The screen is split into a grid of cells per layer and
+// every cell holds exactly one star whose position and size come from a hash
+// of (column, row, layer). Nothing is stored per star, so memory and the number
+// of stars drawn are fixed by the grid no matter how long the game runs.
+struct Starfield {
+    int columns;       // Cells across the screen
+    int rows;          // Cells down the screen
+    int layers;        // Depth layers; further layers scroll slower and have smaller stars
+    bool parallax;     // Scroll the layers with the distance travelled
+    unsigned seed;     // Changes the whole sky
+};
+
+struct StarfieldStar {
+    float x, y;        // Position in screen coordinates (-1..1)
+    float size;        // Radius of the star
+};
+
+// Maximum number of stars BuildStarfield can produce for one frame
+int StarfieldBudget(const Starfield& field);
+
+// Compute the star in a given cell. column is in world space (it keeps
+// increasing as the sky scrolls); scroll is the layer's scroll offset.
+StarfieldStar GetStarfieldStar(const Starfield& field, int layer, int column, int row, float scroll);
+
+// Fill out with the visible stars for the given distance travelled and return
+// how many were written (never more than StarfieldBudget)
+int BuildStarfield(const Starfield& field, float distance, StarfieldStar* out);
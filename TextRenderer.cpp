@@ -0,0 +1,237 @@
+#include "TextRenderer.h"
+
+#include <cmath>
+#include <cstddef>
+
+const int kAtlasWidth = 512;
+const int kGlyphPadding = 2;  // Blank columns on each side of a glyph cell, for overhanging pixels
+
+// The scene uses gluOrtho2D(-1, 1, -1, 1), so scene and normalized device coordinates match
+static float SceneToPixels(float coordinate, int viewportSize) {
+    return (coordinate + 1.0f) * 0.5f * viewportSize;
+}
+
+static float PixelsToScene(float pixels, int viewportSize) {
+    return pixels * 2.0f / viewportSize - 1.0f;
+}
+
+static int NextPowerOfTwo(int value) {
+    int result = 1;
+    while (result < value) {
+        result *= 2;
+    }
+    return result;
+}
+
+void InitGlyphAtlas(GlyphAtlas& atlas) {
+    atlas.fontCount = 0;
+    atlas.texture = 0;
+    atlas.width = 0;
+    atlas.height = 0;
+    atlas.baked = false;
+    atlas.bakeAttempted = false;
+    atlas.viewportWidth = 0;
+    atlas.viewportHeight = 0;
+    atlas.generation = 0;
+}
+
+int AddAtlasFont(GlyphAtlas& atlas, void* glutFont, int cellHeight, int descent) {
+    if (atlas.fontCount == kMaxAtlasFonts) {
+        return -1;
+    }
+    AtlasFont& font = atlas.fonts[atlas.fontCount];
+    font.glutFont = glutFont;
+    font.cellHeight = cellHeight;
+    font.descent = descent;
+    return atlas.fontCount++;
+}
+
+// Assign every glyph a cell, one row of cells after another. Returns the height used.
+static int LayoutGlyphs(GlyphAtlas& atlas) {
+    int x = 0;
+    int y = 0;
+    for (int f = 0; f < atlas.fontCount; f++) {
+        AtlasFont& font = atlas.fonts[f];
+        for (int c = 0; c < kAtlasCharCount; c++) {
+            AtlasGlyph& glyph = font.glyphs[c];
+            glyph.advance = glutBitmapWidth(font.glutFont, kFirstAtlasChar + c);
+            int cellWidth = glyph.advance + 2 * kGlyphPadding;
+            if (x + cellWidth > kAtlasWidth) {
+                x = 0;
+                y += font.cellHeight;
+            }
+            glyph.x = x;
+            glyph.y = y;
+            x += cellWidth;
+        }
+        x = 0;  // Each font starts on a fresh row
+        y += font.cellHeight;
+    }
+    return y;
+}
+
+bool BakeGlyphAtlas(GlyphAtlas& atlas) {
+    atlas.bakeAttempted = true;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    SetTextViewport(atlas, viewport[2], viewport[3]);
+
+    int usedHeight = LayoutGlyphs(atlas);
+    if (kAtlasWidth > viewport[2] || usedHeight > viewport[3]) {
+        return false;  // Glyphs outside the window would not be rendered
+    }
+
+    // Draw the glyphs in window pixels, white on black, at the bottom-left of the window
+    glPushAttrib(GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT | GL_ENABLE_BIT | GL_PIXEL_MODE_BIT);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0.0, viewport[2], 0.0, viewport[3], -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glDisable(GL_BLEND);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    for (int f = 0; f < atlas.fontCount; f++) {
+        const AtlasFont& font = atlas.fonts[f];
+        for (int c = 0; c < kAtlasCharCount; c++) {
+            const AtlasGlyph& glyph = font.glyphs[c];
+            glRasterPos2i(glyph.x + kGlyphPadding, glyph.y + font.descent);
+            glutBitmapCharacter(font.glutFont, kFirstAtlasChar + c);
+        }
+    }
+
+    // Any channel will do: the glyphs are white
+    atlas.width = kAtlasWidth;
+    atlas.height = NextPowerOfTwo(usedHeight);
+    std::vector<unsigned char> pixels((size_t)atlas.width * atlas.height, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadBuffer(GL_BACK);
+    glReadPixels(0, 0, atlas.width, usedHeight, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+    glPopAttrib();
+
+    glGenTextures(1, &atlas.texture);
+    glBindTexture(GL_TEXTURE_2D, atlas.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);  // Quads are pixel aligned
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, atlas.width, atlas.height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, pixels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    atlas.baked = true;
+    atlas.generation++;
+    return true;
+}
+
+void SetTextViewport(GlyphAtlas& atlas, int width, int height) {
+    if (width != atlas.viewportWidth || height != atlas.viewportHeight) {
+        atlas.viewportWidth = width;
+        atlas.viewportHeight = height;
+        atlas.generation++;
+    }
+}
+
+void InitTextLabel(TextLabel& label) {
+    label.vertices.clear();
+    label.value = 0;
+    label.generation = -1;  // Never current
+}
+
+bool TextLabelIsCurrent(const TextLabel& label, const GlyphAtlas& atlas, int value) {
+    return label.generation == atlas.generation && label.value == value;
+}
+
+void ResetTextLabel(TextLabel& label, const GlyphAtlas& atlas, int value) {
+    label.vertices.clear();
+    label.value = value;
+    label.generation = atlas.generation;
+}
+
+static void AddTextVertex(TextLabel& label, const GlyphAtlas& atlas, float px, float py, float u, float v, const unsigned char color[4]) {
+    TextVertex vertex;
+    vertex.x = PixelsToScene(px, atlas.viewportWidth);
+    vertex.y = PixelsToScene(py, atlas.viewportHeight);
+    vertex.u = u / atlas.width;
+    vertex.v = v / atlas.height;
+    vertex.r = color[0];
+    vertex.g = color[1];
+    vertex.b = color[2];
+    vertex.a = color[3];
+    label.vertices.push_back(vertex);
+}
+
+void AppendText(TextLabel& label, const GlyphAtlas& atlas, int font, const char* text, float x, float y,
+                float r, float g, float b) {
+    if (!atlas.baked || font < 0 || font >= atlas.fontCount) {
+        return;
+    }
+    const AtlasFont& atlasFont = atlas.fonts[font];
+    unsigned char color[4] = { (unsigned char)(r * 255.0f + 0.5f), (unsigned char)(g * 255.0f + 0.5f), (unsigned char)(b * 255.0f + 0.5f), 255 };
+
+    // Pen position in window pixels; glBitmap places glyphs at whole pixels below it
+    float penX = SceneToPixels(x, atlas.viewportWidth);
+    float baseline = floorf(SceneToPixels(y, atlas.viewportHeight));
+    for (const char* c = text; *c != '\0'; c++) {
+        int index = (unsigned char)*c - kFirstAtlasChar;
+        if (index < 0 || index >= kAtlasCharCount) {
+            continue;
+        }
+        const AtlasGlyph& glyph = atlasFont.glyphs[index];
+        int cellWidth = glyph.advance + 2 * kGlyphPadding;
+
+        float left = floorf(penX) - kGlyphPadding;
+        float bottom = baseline - atlasFont.descent;
+        float right = left + cellWidth;
+        float top = bottom + atlasFont.cellHeight;
+        float u0 = (float)glyph.x;
+        float v0 = (float)glyph.y;
+        float u1 = u0 + cellWidth;
+        float v1 = v0 + atlasFont.cellHeight;
+        AddTextVertex(label, atlas, left, bottom, u0, v0, color);
+        AddTextVertex(label, atlas, right, bottom, u1, v0, color);
+        AddTextVertex(label, atlas, right, top, u1, v1, color);
+        AddTextVertex(label, atlas, left, top, u0, v1, color);
+
+        penX += glyph.advance;
+    }
+}
+
+void DrawTextLabel(const GlyphAtlas& atlas, const TextLabel& label) {
+    if (!atlas.baked || label.vertices.empty()) {
+        return;
+    }
+    size_t stride = sizeof(TextVertex);
+    const char* base = (const char*)label.vertices.data();
+
+    // Alpha test keeps the bitmap look (a pixel is either set or not) without enabling blending
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, atlas.texture);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    glEnable(GL_ALPHA_TEST);
+    glAlphaFunc(GL_GREATER, 0.5f);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, (GLsizei)stride, base + offsetof(TextVertex, x));
+    glTexCoordPointer(2, GL_FLOAT, (GLsizei)stride, base + offsetof(TextVertex, u));
+    glColorPointer(4, GL_UNSIGNED_BYTE, (GLsizei)stride, base + offsetof(TextVertex, r));
+    glDrawArrays(GL_QUADS, 0, (GLsizei)label.vertices.size());
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    glPopAttrib();
+}
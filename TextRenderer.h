@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+#include "GLIncludes.h"
+
+// Text drawn from a glyph atlas instead of glutBitmapCharacter. The GLUT
+// bitmap fonts are rendered once into the back buffer, read back and kept in
+// an alpha texture; a string then becomes a list of textured quads that can be
+// built once and drawn again every frame with a single call.
+
+const int kFirstAtlasChar = 32;   // Space
+const int kLastAtlasChar = 126;   // Tilde
+const int kAtlasCharCount = kLastAtlasChar - kFirstAtlasChar + 1;
+const int kMaxAtlasFonts = 4;
+
+struct AtlasGlyph {
+    int x, y;                     // Lower-left corner of the glyph cell in the atlas, pixels
+    int advance;                  // Pen movement, as reported by glutBitmapWidth
+};
+
+struct AtlasFont {
+    void* glutFont;               // GLUT_BITMAP_* handle
+    int cellHeight;               // Pixel rows kept for every glyph
+    int descent;                  // Rows of the cell below the baseline
+    AtlasGlyph glyphs[kAtlasCharCount];
+};
+
+struct GlyphAtlas {
+    AtlasFont fonts[kMaxAtlasFonts];
+    int fontCount;
+
+    GLuint texture;
+    int width, height;            // Texture size (powers of two)
+    bool baked;                   // False until BakeGlyphAtlas succeeds
+    bool bakeAttempted;
+
+    int viewportWidth, viewportHeight;  // Window size the quads are laid out for
+    int generation;               // Bumped when cached quads become stale
+};
+
+struct TextVertex {
+    float x, y;                   // Scene coordinates
+    float u, v;
+    unsigned char r, g, b, a;
+};
+
+// Cached quads for one string. Callers rebuild a label only when the value it
+// shows changes (see TextLabelIsCurrent).
+struct TextLabel {
+    std::vector<TextVertex> vertices;
+    int value;                    // Caller-defined, e.g. the score the text shows
+    int generation;               // Atlas generation the quads were built for
+};
+
+void InitGlyphAtlas(GlyphAtlas& atlas);
+
+// Register a GLUT bitmap font before baking. Returns the font index used by
+// AppendText, or -1 if kMaxAtlasFonts fonts are registered already.
+int AddAtlasFont(GlyphAtlas& atlas, void* glutFont, int cellHeight, int descent);
+
+// Render every registered font into the back buffer and copy it into the
+// atlas texture. Call at the start of a frame, before glClear, once the
+// window is visible. Returns false (and leaves the atlas unbaked) if the
+// window is too small to hold the atlas.
+bool BakeGlyphAtlas(GlyphAtlas& atlas);
+
+// Call when the window size changes; cached labels become stale
+void SetTextViewport(GlyphAtlas& atlas, int width, int height);
+
+void InitTextLabel(TextLabel& label);
+
+bool TextLabelIsCurrent(const TextLabel& label, const GlyphAtlas& atlas, int value);
+
+// Drop the label's quads and mark it as showing value
+void ResetTextLabel(TextLabel& label, const GlyphAtlas& atlas, int value);
+
+// Append the quads for text, starting at raster position (x, y) in scene
+// coordinates like glRasterPos2f
+void AppendText(TextLabel& label, const GlyphAtlas& atlas, int font, const char* text, float x, float y,
+                float r, float g, float b);
+
+// Draw a label in one call
+void DrawTextLabel(const GlyphAtlas& atlas, const TextLabel& label);
@@ -0,0 +1,165 @@
+#include "TimerWheel.h"
+
+const int kTimerIndexBits = 8;  // TimerId: generation above, node index below
+static_assert(kMaxTimers <= (1 << kTimerIndexBits), "TimerId has room for 256 nodes");
+
+void InitTimerWheel(TimerWheel& wheel, long now) {
+    wheel.now = now;
+    for (int i = 0; i < kTimerLevels * kTimerSlots; i++) {
+        wheel.slots[i] = -1;
+    }
+    for (int i = 0; i < kMaxTimers; i++) {
+        TimerNode& node = wheel.nodes[i];
+        node.next = (short)(i + 1 < kMaxTimers ? i + 1 : -1);
+        node.prev = -1;
+        node.slot = -1;
+        node.generation = 0;
+    }
+    wheel.freeList = 0;
+    wheel.pending = 0;
+}
+
+// Node of a pending timer, or -1
+static int PendingNode(const TimerWheel& wheel, TimerId timer) {
+    if (timer < 0) {
+        return -1;
+    }
+    int index = timer & ((1 << kTimerIndexBits) - 1);
+    if (index >= kMaxTimers) {
+        return -1;
+    }
+    const TimerNode& node = wheel.nodes[index];
+    if (node.slot < 0 || node.generation != (unsigned short)(timer >> kTimerIndexBits)) {
+        return -1;
+    }
+    return index;
+}
+
+// Slot for a timer due at due: the lowest level whose span still reaches it
+static int SlotFor(const TimerWheel& wheel, long due) {
+    long ahead = due - wheel.now;
+    for (int level = 0; level < kTimerLevels - 1; level++) {
+        if (ahead < (1L << (kTimerSlotBits * (level + 1)))) {
+            return level * kTimerSlots + (int)((due >> (kTimerSlotBits * level)) & (kTimerSlots - 1));
+        }
+    }
+    int top = kTimerLevels - 1;
+    return top * kTimerSlots + (int)((due >> (kTimerSlotBits * top)) & (kTimerSlots - 1));
+}
+
+// Append node at the back of its due tick's slot
+static void LinkNode(TimerWheel& wheel, int index) {
+    TimerNode& node = wheel.nodes[index];
+    int slot = SlotFor(wheel, node.due);
+    node.slot = (short)slot;
+    short head = wheel.slots[slot];
+    if (head < 0) {
+        node.next = node.prev = (short)index;
+        wheel.slots[slot] = (short)index;
+        return;
+    }
+    TimerNode& first = wheel.nodes[head];
+    node.next = head;
+    node.prev = first.prev;
+    wheel.nodes[first.prev].next = (short)index;
+    first.prev = (short)index;
+}
+
+static void UnlinkNode(TimerWheel& wheel, int index) {
+    TimerNode& node = wheel.nodes[index];
+    if (node.next == index) {
+        wheel.slots[node.slot] = -1;  // Was the only one
+    }
+    else {
+        wheel.nodes[node.prev].next = node.next;
+        wheel.nodes[node.next].prev = node.prev;
+        if (wheel.slots[node.slot] == index) {
+            wheel.slots[node.slot] = node.next;
+        }
+    }
+    node.slot = -1;
+}
+
+static void FreeNode(TimerWheel& wheel, int index) {
+    TimerNode& node = wheel.nodes[index];
+    node.generation++;
+    node.next = wheel.freeList;
+    wheel.freeList = (short)index;
+    wheel.pending--;
+}
+
+TimerId ScheduleTimer(TimerWheel& wheel, long delay, TimerCallback callback, int payload) {
+    if (wheel.freeList < 0) {
+        return kNoTimer;
+    }
+    int index = wheel.freeList;
+    TimerNode& node = wheel.nodes[index];
+    wheel.freeList = node.next;
+    wheel.pending++;
+
+    node.due = wheel.now + (delay < 0 ? 0 : (delay > kMaxTimerDelay ? kMaxTimerDelay : delay));
+    node.callback = callback;
+    node.payload = payload;
+    LinkNode(wheel, index);
+    return (TimerId)node.generation << kTimerIndexBits | index;
+}
+
+bool CancelTimer(TimerWheel& wheel, TimerId timer) {
+    int index = PendingNode(wheel, timer);
+    if (index < 0) {
+        return false;
+    }
+    UnlinkNode(wheel, index);
+    FreeNode(wheel, index);
+    return true;
+}
+
+bool ExtendTimer(TimerWheel& wheel, TimerId timer, long ticks) {
+    int index = PendingNode(wheel, timer);
+    if (index < 0) {
+        return false;
+    }
+    UnlinkNode(wheel, index);
+    TimerNode& node = wheel.nodes[index];
+    long delay = node.due + ticks - wheel.now;
+    node.due = wheel.now + (delay < 0 ? 0 : (delay > kMaxTimerDelay ? kMaxTimerDelay : delay));
+    LinkNode(wheel, index);
+    return true;
+}
+
+// Move every timer of a higher-level slot down to the slot it belongs in now
+static void CascadeSlot(TimerWheel& wheel, int slot) {
+    int index = wheel.slots[slot];
+    while (index >= 0) {
+        UnlinkNode(wheel, index);
+        LinkNode(wheel, index);
+        index = wheel.slots[slot];
+    }
+}
+
+void AdvanceTimerWheel(TimerWheel& wheel, void* context) {
+    long now = wheel.now;
+    if (wheel.pending == 0) {
+        wheel.now = now + 1;  // Nothing to fire or move down
+        return;
+    }
+    // At the start of each span of a level, its timers for that span move
+    // down; the higher level goes first so its timers can move two levels
+    for (int level = kTimerLevels - 1; level > 0; level--) {
+        if ((now & ((1L << (kTimerSlotBits * level)) - 1)) == 0) {
+            CascadeSlot(wheel, level * kTimerSlots + (int)((now >> (kTimerSlotBits * level)) & (kTimerSlots - 1)));
+        }
+    }
+
+    int slot = (int)(now & (kTimerSlots - 1));
+    int index;
+    while ((index = wheel.slots[slot]) >= 0) {
+        TimerNode& node = wheel.nodes[index];
+        TimerCallback callback = node.callback;
+        int payload = node.payload;
+        UnlinkNode(wheel, index);
+        FreeNode(wheel, index);  // Before the callback, which may schedule into it again
+        callback(context, payload);
+    }
+    wheel.now = now + 1;
+}
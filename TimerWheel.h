@@ -0,0 +1,62 @@
+#pragma once
+
+// Hierarchical timer wheel keyed on simulation ticks. Timers are scheduled a
+// number of ticks ahead and call back when that tick is advanced past;
+// scheduling, cancelling and extending a timer are O(1), and advancing a tick
+// with nothing due costs one slot check, however many timers are pending.
+//
+// Three levels of kTimerSlots slots each: level 0 holds the timers due within
+// the next 64 ticks, one slot per tick; levels 1 and 2 hold later timers in
+// slots of 64 and 4096 ticks, which are moved down a level as their turn
+// comes. Everything is stored inline and linked by index, so a wheel never
+// allocates and copying it (as GameWorld copies are) copies every timer.
+
+const int kTimerSlotBits = 6;
+const int kTimerSlots = 1 << kTimerSlotBits;
+const int kTimerLevels = 3;
+const long kMaxTimerDelay = (1L << (kTimerSlotBits * kTimerLevels)) - 1;  // 262143 ticks, over an hour
+const int kMaxTimers = 32;
+
+// Identifies a scheduled timer. Stays invalid once the timer has fired or
+// been cancelled, even after its storage is reused.
+typedef int TimerId;
+const TimerId kNoTimer = -1;
+
+// Called when a timer fires, with the context passed to AdvanceTimerWheel
+// and the payload given to ScheduleTimer
+typedef void (*TimerCallback)(void* context, int payload);
+
+struct TimerNode {
+    long due;                   // Tick the timer fires at
+    TimerCallback callback;
+    int payload;
+    short next, prev;           // Neighbours in the slot's circular list; next links the free list
+    short slot;                 // Index into TimerWheel::slots, -1 while free
+    unsigned short generation;  // Bumped whenever the node is freed, to invalidate old TimerIds
+};
+
+struct TimerWheel {
+    long now;                                   // Tick the next AdvanceTimerWheel fires the timers of
+    short slots[kTimerLevels * kTimerSlots];    // First timer of each slot, -1 if empty
+    TimerNode nodes[kMaxTimers];
+    short freeList;                             // First free node, -1 if all are in use
+    int pending;                                // Timers scheduled and not yet fired or cancelled
+};
+
+// Empty wheel whose next AdvanceTimerWheel is for tick now
+void InitTimerWheel(TimerWheel& wheel, long now);
+
+// Fire callback delay ticks from now: delay 0 fires when the current tick is
+// advanced, 1 the tick after. Delays above kMaxTimerDelay are clamped.
+// Returns kNoTimer if kMaxTimers timers are pending already.
+TimerId ScheduleTimer(TimerWheel& wheel, long delay, TimerCallback callback, int payload);
+
+// Returns false if the timer is not pending (it fired, or was cancelled)
+bool CancelTimer(TimerWheel& wheel, TimerId timer);
+
+// Push a pending timer's tick back by ticks. Returns false if it is not pending.
+bool ExtendTimer(TimerWheel& wheel, TimerId timer, long ticks);
+
+// Fire the timers due at wheel.now and move on to the next tick. Callbacks
+// may schedule and cancel timers.
+void AdvanceTimerWheel(TimerWheel& wheel, void* context);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+
+// Lock-free hand-over of the latest value from one thread to another. The
+// writer fills its back slot and swaps it into the middle; the reader swaps
+// the middle into its front slot whenever a newer value waits there. Neither
+// side ever waits for the other or copies more than it writes: the reader
+// always sees one complete value, and values it was too slow for are skipped.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1), back(2), front(0) {}
+
+    // Writer side: the slot to fill, then publish() it
+    T& writeSlot() { return slots[back]; }
+
+    void publish() {
+        back = middle.exchange(back | kFresh, std::memory_order_acq_rel) & kIndexMask;  // Releases the filled slot
+    }
+
+    // Reader side: the newest published value, or the one read last time if
+    // nothing was published since. Valid until the next read().
+    const T& read() {
+        if (middle.load(std::memory_order_relaxed) & kFresh) {
+            front = middle.exchange(front, std::memory_order_acq_rel) & kIndexMask;  // Acquires the new slot
+        }
+        return slots[front];
+    }
+
+private:
+    static const unsigned int kIndexMask = 3;
+    static const unsigned int kFresh = 4;  // Set in middle while it holds a value the reader has not seen
+
+    T slots[3];
+    alignas(64) std::atomic<unsigned int> middle;  // Slot between the two sides, plus kFresh
+    alignas(64) unsigned int back;   // Writer's slot
+    alignas(64) unsigned int front;  // Reader's slot
+};
@@ -0,0 +1,76 @@
+#include "WorkStealing.h"
+
+static unsigned long long PackRange(unsigned int begin, unsigned int end) {
+    return (unsigned long long)end << 32 | begin;
+}
+
+static unsigned int RangeBegin(unsigned long long bounds) {
+    return (unsigned int)bounds;
+}
+
+static unsigned int RangeEnd(unsigned long long bounds) {
+    return (unsigned int)(bounds >> 32);
+}
+
+void SplitWork(WorkRanges& work, unsigned int count, int workers) {
+    work.workers = workers > 0 ? workers : 1;
+    work.ranges.reset(new WorkRange[work.workers]);
+    for (int i = 0; i < work.workers; i++) {
+        unsigned int begin = (unsigned int)((unsigned long long)count * i / work.workers);
+        unsigned int end = (unsigned int)((unsigned long long)count * (i + 1) / work.workers);
+        work.ranges[i].bounds.store(PackRange(begin, end), std::memory_order_relaxed);
+    }
+}
+
+// Take up to grain indices off the front of the worker's own range
+static bool TakeOwn(WorkRange& range, unsigned int grain, unsigned int& begin, unsigned int& end) {
+    unsigned long long bounds = range.bounds.load(std::memory_order_acquire);
+    while (RangeBegin(bounds) < RangeEnd(bounds)) {
+        unsigned int take = RangeEnd(bounds) - RangeBegin(bounds) < grain ? RangeEnd(bounds) : RangeBegin(bounds) + grain;
+        if (range.bounds.compare_exchange_weak(bounds, PackRange(take, RangeEnd(bounds)), std::memory_order_acq_rel)) {
+            begin = RangeBegin(bounds);
+            end = take;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Take the back half of a victim's range. The owner keeps the front half,
+// which it is working through anyway.
+static bool Steal(WorkRange& victim, unsigned int& begin, unsigned int& end) {
+    unsigned long long bounds = victim.bounds.load(std::memory_order_acquire);
+    while (RangeBegin(bounds) < RangeEnd(bounds)) {
+        unsigned int middle = RangeBegin(bounds) + (RangeEnd(bounds) - RangeBegin(bounds)) / 2;
+        if (victim.bounds.compare_exchange_weak(bounds, PackRange(RangeBegin(bounds), middle), std::memory_order_acq_rel)) {
+            begin = middle;
+            end = RangeEnd(bounds);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TakeWork(WorkRanges& work, int worker, unsigned int grain, unsigned int& begin, unsigned int& end) {
+    WorkRange& own = work.ranges[worker];
+    if (TakeOwn(own, grain, begin, end)) {
+        return true;
+    }
+    for (int i = 1; i < work.workers; i++) {
+        unsigned int stolenBegin, stolenEnd;
+        if (Steal(work.ranges[(worker + i) % work.workers], stolenBegin, stolenEnd)) {
+            // Run the first batch now and make the rest this worker's range, open to thieves in turn.
+            // Nobody else writes an empty range, so a plain store cannot lose one of theirs.
+            end = stolenEnd - stolenBegin < grain ? stolenEnd : stolenBegin + grain;
+            begin = stolenBegin;
+            own.bounds.store(PackRange(end, stolenEnd), std::memory_order_release);
+            return true;
+        }
+    }
+    return false;
+}
+
+int DefaultWorkerCount() {
+    unsigned int threads = std::thread::hardware_concurrency();
+    return threads > 0 ? (int)threads : 1;
+}
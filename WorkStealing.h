@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Work-stealing scheduler for loops over independent items. Each worker owns
+// a contiguous range of the indices and takes small batches off its front.
+// A worker that runs dry steals the back half of another worker's range, so
+// items that take longer than others (a round that survives to the end
+// against one lost in seconds) do not leave the other threads idle.
+//
+// A range is a begin / end pair packed into one atomic word, so the owner and
+// the thieves agree on every index with a single compare-and-swap, and no
+// index is ever run twice or skipped.
+
+struct alignas(64) WorkRange {
+    std::atomic<unsigned long long> bounds;  // begin in the low 32 bits, end in the high 32 bits
+};
+
+struct WorkRanges {
+    std::unique_ptr<WorkRange[]> ranges;
+    int workers;
+};
+
+// Split [0, count) evenly between the workers
+void SplitWork(WorkRanges& work, unsigned int count, int workers);
+
+// Next batch of at most grain indices for worker: from its own range, or
+// stolen from another worker once its own is empty. False when all indices
+// have been handed out.
+bool TakeWork(WorkRanges& work, int worker, unsigned int grain, unsigned int& begin, unsigned int& end);
+
+// Number of workers to use when none is given: one per hardware thread
+int DefaultWorkerCount();
+
+// Calls body(worker, index) for every index in [0, count) on the given
+// number of threads (the calling thread is worker 0) and returns once all
+// calls have returned. Each worker calls body with its own worker number
+// only, so per-worker state needs no locking.
+template <typename Body>
+void RunWorkStealing(unsigned int count, int workers, unsigned int grain, Body body) {
+    WorkRanges work;
+    SplitWork(work, count, workers);
+    auto run = [&work, grain, &body](int worker) {
+        unsigned int begin, end;
+        while (TakeWork(work, worker, grain, begin, end)) {
+            for (unsigned int i = begin; i < end; i++) {
+                body(worker, i);
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int worker = 1; worker < work.workers; worker++) {
+        threads.emplace_back(run, worker);
+    }
+    run(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}